@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AllocationCounter.h"
+
+using namespace std;
+
+atomic<AllocationCounter::ReadFunc> AllocationCounter::Source{ nullptr };
+
+AllocationCounter::AllocationCounter()
+{
+}
+
+AllocationCounter::~AllocationCounter()
+{
+}
+
+void AllocationCounter::SetSource(ReadFunc InRead)
+{
+    Source.store(InRead, memory_order_release);
+}
+
+bool AllocationCounter::IsCounting()
+{
+    return Source.load(memory_order_acquire) != nullptr;
+}
+
+uint64_t AllocationCounter::Read()
+{
+    const ReadFunc Read = Source.load(memory_order_acquire);
+    return Read != nullptr ? Read() : 0;
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CsvCellFormatter.h"
+
+#include <charconv>
+
+using namespace std;
+
+CsvCellFormatter::CsvCellFormatter()
+{
+}
+
+CsvCellFormatter::~CsvCellFormatter()
+{
+}
+
+void CsvCellFormatter::AppendValue(const XlsxCell& InCell, string& OutBuffer)
+{
+    // Large enough for any int64 or a %g formatted double
+    char Digits[32];
+
+    switch (InCell.Type)
+    {
+    case EXlsxCellType::Boolean:
+        // ostream without boolalpha
+        OutBuffer.push_back(InCell.BoolValue ? '1' : '0');
+        break;
+
+    case EXlsxCellType::Integer:
+    {
+        const to_chars_result Result = to_chars(Digits, Digits + sizeof(Digits), InCell.IntValue);
+        OutBuffer.append(Digits, Result.ptr - Digits);
+        break;
+    }
+
+    case EXlsxCellType::Float:
+    {
+        // General format with precision 6 is what the default ostream float formatting produces
+        const to_chars_result Result = to_chars(Digits, Digits + sizeof(Digits), InCell.FloatValue, chars_format::general, 6);
+        OutBuffer.append(Digits, Result.ptr - Digits);
+        break;
+    }
+
+    case EXlsxCellType::String:
+        OutBuffer.append(InCell.Text.data(), InCell.Text.size());
+        break;
+
+    default:
+        break;
+    }
+}
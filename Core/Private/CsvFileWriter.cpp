@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CsvFileWriter.h"
+
+#include <cstring>
+
+#include "zlib.h"
+
+using namespace std;
+
+CsvFileWriter::CsvFileWriter(size_t InBufferSize)
+    : Buffer(InBufferSize > 0 ? InBufferSize : DefaultBufferSize)
+{
+}
+
+CsvFileWriter::~CsvFileWriter()
+{
+    Discard();
+}
+
+bool CsvFileWriter::Open(const filesystem::path& InFilePath)
+{
+    Discard();
+
+    TargetPath = InFilePath;
+    TempPath = InFilePath;
+    TempPath += ".tmp";
+
+    // The stream's own buffer would only add a second copy, ours is flushed in whole chunks
+    File.rdbuf()->pubsetbuf(nullptr, 0);
+    File.open(TempPath, ios::binary | ios::trunc);
+    if (File.is_open() == false)
+    {
+        Fail("Failed to open " + TempPath.string());
+        return false;
+    }
+
+    Used = 0;
+    BytesWritten = 0;
+    Crc = static_cast<uint32_t>(crc32(0L, Z_NULL, 0));
+    LastError.clear();
+    bError = false;
+    return true;
+}
+
+void CsvFileWriter::Append(string_view InText)
+{
+    while (InText.empty() == false && bError == false)
+    {
+        if (Used == Buffer.size())
+        {
+            Flush();
+        }
+
+        const size_t Count = min(InText.size(), Buffer.size() - Used);
+        memcpy(Buffer.data() + Used, InText.data(), Count);
+        Used += Count;
+        InText.remove_prefix(Count);
+    }
+}
+
+void CsvFileWriter::Append(char InChar)
+{
+    if (Used == Buffer.size())
+    {
+        Flush();
+    }
+
+    if (bError == false)
+    {
+        Buffer[Used++] = InChar;
+    }
+}
+
+void CsvFileWriter::Flush()
+{
+    if (Used == 0 || bError)
+    {
+        return;
+    }
+
+    File.write(Buffer.data(), static_cast<streamsize>(Used));
+    if (File.fail())
+    {
+        Fail("Failed to write " + TempPath.string());
+        return;
+    }
+
+    Crc = static_cast<uint32_t>(crc32(Crc, reinterpret_cast<const Bytef*>(Buffer.data()), static_cast<uInt>(Used)));
+    BytesWritten += Used;
+    Used = 0;
+}
+
+bool CsvFileWriter::Commit()
+{
+    if (File.is_open() == false)
+    {
+        return false;
+    }
+
+    Flush();
+    File.close();
+
+    if (bError || File.fail())
+    {
+        Fail("Failed to write " + TempPath.string());
+        Discard();
+        return false;
+    }
+
+    // Replaces an existing CSV in one step, readers see either the old or the new file
+    error_code Error;
+    filesystem::rename(TempPath, TargetPath, Error);
+    if (Error)
+    {
+        Fail("Failed to replace " + TargetPath.string() + " : " + Error.message());
+        Discard();
+        return false;
+    }
+
+    TempPath.clear();
+    return true;
+}
+
+void CsvFileWriter::Discard()
+{
+    if (File.is_open())
+    {
+        File.close();
+    }
+
+    if (TempPath.empty() == false)
+    {
+        error_code Error;
+        filesystem::remove(TempPath, Error);
+        TempPath.clear();
+    }
+
+    Used = 0;
+}
+
+void CsvFileWriter::Fail(string InMessage)
+{
+    if (bError == false)
+    {
+        LastError = move(InMessage);
+        bError = true;
+    }
+}
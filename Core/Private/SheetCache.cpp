@@ -0,0 +1,725 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SheetCache.h"
+#include "CsvFileWriter.h"
+#include "DataTypeTokenTable.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SHEET_CACHE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define SHEET_CACHE_MMAP 0
+#endif
+
+using namespace std;
+
+static constexpr char SheetCacheMagic[4] = { 'D', 'T', 'S', 'C' };
+
+static uint64_t AlignSection(uint64_t InOffset)
+{
+    return (InOffset + 7) & ~static_cast<uint64_t>(7);
+}
+
+static bool IsIntegerType(string_view InUnrealType)
+{
+    return InUnrealType == "int8" || InUnrealType == "uint8" || InUnrealType == "int16" || InUnrealType == "uint16"
+        || InUnrealType == "int32" || InUnrealType == "uint32" || InUnrealType == "int64" || InUnrealType == "uint64";
+}
+
+// Integers and doubles are only stored as numbers when formatting them back gives the CSV text again
+static bool ParseInt(string_view InText, int64_t& OutValue)
+{
+    const from_chars_result Result = from_chars(InText.data(), InText.data() + InText.size(), OutValue);
+    if (Result.ec != errc() || Result.ptr != InText.data() + InText.size())
+    {
+        return false;
+    }
+
+    char Digits[32];
+    const to_chars_result Formatted = to_chars(Digits, Digits + sizeof(Digits), OutValue);
+    return string_view(Digits, static_cast<size_t>(Formatted.ptr - Digits)) == InText;
+}
+
+static bool ParseReal(string_view InText, double& OutValue)
+{
+    // Non-finite cells stay text, import would set them directly while the CSV path rejects them
+    const from_chars_result Result = from_chars(InText.data(), InText.data() + InText.size(), OutValue);
+    if (Result.ec != errc() || Result.ptr != InText.data() + InText.size() || isfinite(OutValue) == false)
+    {
+        return false;
+    }
+
+    char Digits[32];
+    const to_chars_result Formatted = to_chars(Digits, Digits + sizeof(Digits), OutValue);
+    return string_view(Digits, static_cast<size_t>(Formatted.ptr - Digits)) == InText;
+}
+
+SheetCacheWriter::SheetCacheWriter(size_t InBlockRows)
+    : BlockRows(InBlockRows > 0 ? InBlockRows : DefaultBlockRows)
+{
+}
+
+SheetCacheWriter::~SheetCacheWriter()
+{
+    Discard();
+}
+
+bool SheetCacheWriter::Open(const filesystem::path& InFilePath, string& OutError)
+{
+    Discard();
+
+    TargetPath = InFilePath;
+    SpillPath = InFilePath;
+    SpillPath += ".rows.tmp";
+
+    SpillFile.open(SpillPath, ios::binary | ios::in | ios::out | ios::trunc);
+    if (SpillFile.is_open() == false)
+    {
+        OutError = "Failed to open " + SpillPath.string();
+        SpillPath.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void SheetCacheWriter::AddRow(const SheetTableRow& InRow)
+{
+    if (bError || SpillFile.is_open() == false)
+    {
+        return;
+    }
+
+    if (InRow.Kind != ESheetRowKind::Data)
+    {
+        vector<string>& Header = InRow.Kind == ESheetRowKind::Types ? Types : Names;
+        Header.clear();
+        for (size_t Index = 0; Index < InRow.GetCellCount(); Index++)
+        {
+            Header.emplace_back(InRow.GetCell(Index));
+        }
+        return;
+    }
+
+    if (bColumnsReady == false)
+    {
+        BeginColumns();
+    }
+
+    for (size_t Column = 0; Column < Columns.size(); Column++)
+    {
+        ColumnState& State = Columns[Column];
+        uint64_t& Slot = BlockSlots[Column * BlockRows + BlockUsed];
+        const string_view Cell = Column < InRow.GetCellCount() ? InRow.GetCell(Column) : string_view();
+
+        if (State.Desc.Storage == ESheetCacheStorage::Int)
+        {
+            int64_t Value = 0;
+            if (ParseInt(Cell, Value))
+            {
+                memcpy(&Slot, &Value, sizeof(uint64_t));
+                continue;
+            }
+        }
+        else if (State.Desc.Storage == ESheetCacheStorage::Real)
+        {
+            double Value = 0.0;
+            if (ParseReal(Cell, Value))
+            {
+                memcpy(&Slot, &Value, sizeof(uint64_t));
+                continue;
+            }
+        }
+
+        // Empty or hand-typed cells turn the whole column into text so the cache stays lossless,
+        // the numbers already stored are formatted back into strings on Commit
+        if (State.Desc.Storage != ESheetCacheStorage::String)
+        {
+            State.Desc.Storage = ESheetCacheStorage::String;
+            State.DemotedAtRow = RowCount;
+        }
+        Slot = Intern(Cell);
+    }
+
+    BlockKeys[BlockUsed] = Intern(InRow.Key);
+    BlockUsed++;
+    RowCount++;
+
+    if (BlockUsed == BlockRows)
+    {
+        SpillBlock();
+    }
+}
+
+bool SheetCacheWriter::Commit(string& OutError)
+{
+    if (SpillFile.is_open() == false)
+    {
+        OutError = "Sheet cache is not open";
+        return false;
+    }
+
+    // A table without data rows still records its columns
+    if (bColumnsReady == false)
+    {
+        BeginColumns();
+    }
+
+    SpillFile.flush();
+    if (SpillFile.fail())
+    {
+        Fail("Failed to write " + SpillPath.string());
+    }
+
+    const size_t ColumnCount = Columns.size();
+    const size_t BlockCount = SpilledBlocks + (BlockUsed > 0 ? 1 : 0);
+    auto GetBlockRowCount = [this](size_t InBlock)
+    {
+        return InBlock < SpilledBlocks ? BlockRows : BlockUsed;
+    };
+
+    // Numbers stored before a column was demoted need their text in the dictionary before the offsets are laid out
+    char Digits[32];
+    for (size_t Column = 0; Column < ColumnCount && bError == false; Column++)
+    {
+        const ColumnState& State = Columns[Column];
+        for (size_t Block = 0; Block < BlockCount && Block * BlockRows < State.DemotedAtRow; Block++)
+        {
+            const size_t Count = static_cast<size_t>(min<uint64_t>(GetBlockRowCount(Block), State.DemotedAtRow - Block * BlockRows));
+            const uint64_t* Slots = ReadColumnSlots(Block, Column, Count);
+            for (size_t Row = 0; Row < Count; Row++)
+            {
+                Intern(FormatSlot(State.TypedStorage, Slots[Row], Digits));
+            }
+        }
+    }
+
+    if (bError == false && StringBytes > UINT32_MAX)
+    {
+        Fail("Sheet text is too large for a sheet cache");
+    }
+
+    if (bError)
+    {
+        OutError = LastError;
+        Discard();
+        return false;
+    }
+
+    // Numeric columns first so they start 8 byte aligned without per-column padding, then the 4 byte arrays
+    SheetCacheHeader Header;
+    memset(&Header, 0, sizeof(Header));
+    memcpy(Header.Magic, SheetCacheMagic, sizeof(Header.Magic));
+    Header.Version = Version;
+    Header.ColumnCount = static_cast<uint32_t>(ColumnCount);
+    Header.StringCount = static_cast<uint32_t>(Strings.size());
+    Header.RowCount = RowCount;
+
+    vector<SheetCacheColumn> Descs(ColumnCount);
+    uint64_t Offset = sizeof(SheetCacheHeader) + ColumnCount * sizeof(SheetCacheColumn);
+    for (size_t Column = 0; Column < ColumnCount; Column++)
+    {
+        Descs[Column] = Columns[Column].Desc;
+        if (Descs[Column].Storage != ESheetCacheStorage::String)
+        {
+            Descs[Column].DataOffset = Offset;
+            Offset += RowCount * sizeof(uint64_t);
+        }
+    }
+
+    Header.KeysOffset = Offset;
+    Offset = AlignSection(Offset + RowCount * sizeof(uint32_t));
+    for (size_t Column = 0; Column < ColumnCount; Column++)
+    {
+        if (Descs[Column].Storage == ESheetCacheStorage::String)
+        {
+            Descs[Column].DataOffset = Offset;
+            Offset = AlignSection(Offset + RowCount * sizeof(uint32_t));
+        }
+    }
+
+    Header.StringOffsetsOffset = Offset;
+    Header.StringBytesOffset = AlignSection(Offset + (Strings.size() + 1) * sizeof(uint32_t));
+
+    CsvFileWriter Writer;
+    if (Writer.Open(TargetPath) == false)
+    {
+        OutError = Writer.GetLastError();
+        Discard();
+        return false;
+    }
+
+    uint64_t Written = 0;
+    auto Append = [&](const void* InData, size_t InSize)
+    {
+        Writer.Append(string_view(static_cast<const char*>(InData), InSize));
+        Written += InSize;
+    };
+    auto Pad = [&]()
+    {
+        while (Written != AlignSection(Written))
+        {
+            Writer.Append('\0');
+            Written++;
+        }
+    };
+
+    Append(&Header, sizeof(Header));
+    Append(Descs.data(), Descs.size() * sizeof(SheetCacheColumn));
+
+    // Each section is copied block by block, the spill file is read one column slice at a time
+    for (size_t Column = 0; Column < ColumnCount; Column++)
+    {
+        if (Descs[Column].Storage != ESheetCacheStorage::String)
+        {
+            for (size_t Block = 0; Block < BlockCount; Block++)
+            {
+                const size_t Count = GetBlockRowCount(Block);
+                Append(ReadColumnSlots(Block, Column, Count), Count * sizeof(uint64_t));
+            }
+        }
+    }
+
+    for (size_t Block = 0; Block < BlockCount; Block++)
+    {
+        const size_t Count = GetBlockRowCount(Block);
+        Append(ReadKeys(Block, Count), Count * sizeof(uint32_t));
+    }
+    Pad();
+
+    vector<uint32_t> Ids(BlockRows);
+    for (size_t Column = 0; Column < ColumnCount; Column++)
+    {
+        if (Descs[Column].Storage != ESheetCacheStorage::String)
+        {
+            continue;
+        }
+
+        const ColumnState& State = Columns[Column];
+        for (size_t Block = 0; Block < BlockCount; Block++)
+        {
+            const size_t Count = GetBlockRowCount(Block);
+            const uint64_t* Slots = ReadColumnSlots(Block, Column, Count);
+            for (size_t Row = 0; Row < Count; Row++)
+            {
+                if (Block * BlockRows + Row < State.DemotedAtRow)
+                {
+                    Ids[Row] = StringIds.find(FormatSlot(State.TypedStorage, Slots[Row], Digits))->second;
+                }
+                else
+                {
+                    Ids[Row] = static_cast<uint32_t>(Slots[Row]);
+                }
+            }
+            Append(Ids.data(), Count * sizeof(uint32_t));
+        }
+        Pad();
+    }
+
+    uint32_t StringOffset = 0;
+    for (const string& Text : Strings)
+    {
+        Append(&StringOffset, sizeof(uint32_t));
+        StringOffset += static_cast<uint32_t>(Text.size());
+    }
+    Append(&StringOffset, sizeof(uint32_t));
+    Pad();
+
+    for (const string& Text : Strings)
+    {
+        Writer.Append(Text);
+    }
+
+    if (bError)
+    {
+        OutError = LastError;
+        Writer.Discard();
+        Discard();
+        return false;
+    }
+
+    if (Writer.Commit() == false)
+    {
+        OutError = Writer.GetLastError();
+        Discard();
+        return false;
+    }
+
+    Discard();
+    return true;
+}
+
+void SheetCacheWriter::Discard()
+{
+    if (SpillFile.is_open())
+    {
+        SpillFile.close();
+    }
+    SpillFile.clear();
+
+    if (SpillPath.empty() == false)
+    {
+        error_code Error;
+        filesystem::remove(SpillPath, Error);
+        SpillPath.clear();
+    }
+
+    SpilledBlocks = 0;
+    RowCount = 0;
+    Types.clear();
+    Names.clear();
+    Columns.clear();
+    bColumnsReady = false;
+
+    vector<uint64_t>().swap(BlockSlots);
+    vector<uint32_t>().swap(BlockKeys);
+    BlockUsed = 0;
+    vector<uint64_t>().swap(ReadSlots);
+    vector<uint32_t>().swap(ReadKeyIds);
+
+    StringIds.clear();
+    Strings.clear();
+    StringBytes = 0;
+
+    LastError.clear();
+    bError = false;
+}
+
+void SheetCacheWriter::BeginColumns()
+{
+    Columns.resize(Names.size());
+    for (size_t Column = 0; Column < Columns.size(); Column++)
+    {
+        const string_view Type = Column < Types.size() ? string_view(Types[Column]) : string_view();
+
+        SheetCacheColumn& Desc = Columns[Column].Desc;
+        memset(&Desc, 0, sizeof(Desc));
+        Desc.NameId = Intern(Names[Column]);
+        Desc.TypeId = Intern(Type);
+        Desc.Storage = ESheetCacheStorage::String;
+
+        const DataTypeToken* Token = DataTypeTokenTable::Find(Type);
+        if (Token != nullptr && IsIntegerType(Token->UnrealType))
+        {
+            Desc.Storage = ESheetCacheStorage::Int;
+        }
+        else if (Token != nullptr && (Token->UnrealType == "float" || Token->UnrealType == "double"))
+        {
+            Desc.Storage = ESheetCacheStorage::Real;
+        }
+        Columns[Column].TypedStorage = Desc.Storage;
+    }
+
+    BlockSlots.assign(Columns.size() * BlockRows, 0);
+    BlockKeys.assign(BlockRows, 0);
+    BlockUsed = 0;
+    bColumnsReady = true;
+}
+
+uint32_t SheetCacheWriter::Intern(string_view InText)
+{
+    const auto Found = StringIds.find(InText);
+    if (Found != StringIds.end())
+    {
+        return Found->second;
+    }
+
+    const uint32_t Id = static_cast<uint32_t>(Strings.size());
+    Strings.emplace_back(InText);
+    StringIds.emplace(Strings.back(), Id);
+    StringBytes += InText.size();
+    return Id;
+}
+
+void SheetCacheWriter::SpillBlock()
+{
+    // Fixed-size records : every column's slots for BlockRows rows, then the keys
+    SpillFile.write(reinterpret_cast<const char*>(BlockSlots.data()), static_cast<streamsize>(BlockSlots.size() * sizeof(uint64_t)));
+    SpillFile.write(reinterpret_cast<const char*>(BlockKeys.data()), static_cast<streamsize>(BlockKeys.size() * sizeof(uint32_t)));
+    if (SpillFile.fail())
+    {
+        Fail("Failed to write " + SpillPath.string());
+        return;
+    }
+
+    SpilledBlocks++;
+    BlockUsed = 0;
+}
+
+const uint64_t* SheetCacheWriter::ReadColumnSlots(size_t InBlock, size_t InColumn, size_t InCount)
+{
+    if (InBlock == SpilledBlocks)
+    {
+        return BlockSlots.data() + InColumn * BlockRows;
+    }
+
+    const uint64_t BlockBytes = Columns.size() * BlockRows * sizeof(uint64_t) + BlockRows * sizeof(uint32_t);
+    ReadSlots.resize(InCount);
+    SpillFile.seekg(static_cast<streamoff>(InBlock * BlockBytes + InColumn * BlockRows * sizeof(uint64_t)));
+    SpillFile.read(reinterpret_cast<char*>(ReadSlots.data()), static_cast<streamsize>(InCount * sizeof(uint64_t)));
+    if (SpillFile.fail())
+    {
+        Fail("Failed to read " + SpillPath.string());
+        fill(ReadSlots.begin(), ReadSlots.end(), 0);
+    }
+    return ReadSlots.data();
+}
+
+const uint32_t* SheetCacheWriter::ReadKeys(size_t InBlock, size_t InCount)
+{
+    if (InBlock == SpilledBlocks)
+    {
+        return BlockKeys.data();
+    }
+
+    const uint64_t BlockBytes = Columns.size() * BlockRows * sizeof(uint64_t) + BlockRows * sizeof(uint32_t);
+    ReadKeyIds.resize(InCount);
+    SpillFile.seekg(static_cast<streamoff>(InBlock * BlockBytes + Columns.size() * BlockRows * sizeof(uint64_t)));
+    SpillFile.read(reinterpret_cast<char*>(ReadKeyIds.data()), static_cast<streamsize>(InCount * sizeof(uint32_t)));
+    if (SpillFile.fail())
+    {
+        Fail("Failed to read " + SpillPath.string());
+        fill(ReadKeyIds.begin(), ReadKeyIds.end(), 0);
+    }
+    return ReadKeyIds.data();
+}
+
+string_view SheetCacheWriter::FormatSlot(ESheetCacheStorage InStorage, uint64_t InSlot, char (&OutDigits)[32])
+{
+    to_chars_result Formatted;
+    if (InStorage == ESheetCacheStorage::Int)
+    {
+        int64_t Value = 0;
+        memcpy(&Value, &InSlot, sizeof(Value));
+        Formatted = to_chars(OutDigits, OutDigits + sizeof(OutDigits), Value);
+    }
+    else
+    {
+        double Value = 0.0;
+        memcpy(&Value, &InSlot, sizeof(Value));
+        Formatted = to_chars(OutDigits, OutDigits + sizeof(OutDigits), Value);
+    }
+    return string_view(OutDigits, static_cast<size_t>(Formatted.ptr - OutDigits));
+}
+
+void SheetCacheWriter::Fail(string InMessage)
+{
+    if (bError == false)
+    {
+        LastError = move(InMessage);
+        bError = true;
+    }
+}
+
+SheetCache::SheetCache()
+{
+}
+
+SheetCache::~SheetCache()
+{
+    Close();
+}
+
+bool SheetCache::Open(const filesystem::path& InFilePath, string& OutError)
+{
+    Close();
+
+#if SHEET_CACHE_MMAP
+    const int File = open(InFilePath.c_str(), O_RDONLY);
+    if (File < 0)
+    {
+        OutError = "Failed to open " + InFilePath.string();
+        return false;
+    }
+
+    struct stat FileStat;
+    if (fstat(File, &FileStat) != 0 || FileStat.st_size <= 0)
+    {
+        close(File);
+        OutError = "Failed to read " + InFilePath.string();
+        return false;
+    }
+
+    // Pages are read on first touch, so a consumer only pays for the columns it uses
+    void* Mapped = mmap(nullptr, static_cast<size_t>(FileStat.st_size), PROT_READ, MAP_PRIVATE, File, 0);
+    close(File);
+    if (Mapped == MAP_FAILED)
+    {
+        OutError = "Failed to map " + InFilePath.string();
+        return false;
+    }
+
+    Mapping = Mapped;
+    Data = static_cast<const uint8_t*>(Mapped);
+    Size = static_cast<size_t>(FileStat.st_size);
+#else
+    // One read into memory we own, keeps platform headers out of the engine's unity builds
+    ifstream File(InFilePath, ios::binary | ios::ate);
+    if (File.is_open() == false)
+    {
+        OutError = "Failed to open " + InFilePath.string();
+        return false;
+    }
+
+    Loaded.resize(static_cast<size_t>(File.tellg()));
+    File.seekg(0);
+    if (Loaded.empty() || File.read(reinterpret_cast<char*>(Loaded.data()), static_cast<streamsize>(Loaded.size())).good() == false)
+    {
+        Loaded.clear();
+        OutError = "Failed to read " + InFilePath.string();
+        return false;
+    }
+
+    Data = Loaded.data();
+    Size = Loaded.size();
+#endif
+
+    if (Validate(OutError) == false)
+    {
+        OutError = InFilePath.string() + " : " + OutError;
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool SheetCache::OpenView(const void* InData, size_t InSize, string& OutError)
+{
+    Close();
+
+    Data = static_cast<const uint8_t*>(InData);
+    Size = InSize;
+
+    if (Validate(OutError) == false)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void SheetCache::Close()
+{
+#if SHEET_CACHE_MMAP
+    if (Mapping != nullptr)
+    {
+        munmap(Mapping, Size);
+    }
+#endif
+
+    Mapping = nullptr;
+    vector<uint8_t>().swap(Loaded);
+
+    Data = nullptr;
+    Size = 0;
+    Header = nullptr;
+    Columns = nullptr;
+    Keys = nullptr;
+    StringOffsets = nullptr;
+    StringBytes = nullptr;
+}
+
+bool SheetCache::Validate(string& OutError)
+{
+    // Every offset is checked once here so the accessors can index without bounds checks
+    auto IsSection = [this](uint64_t InOffset, uint64_t InCount, uint64_t InElementSize)
+    {
+        return InOffset % 8 == 0 && InOffset <= Size && InCount <= (Size - InOffset) / InElementSize;
+    };
+
+    if (Data == nullptr || Size < sizeof(SheetCacheHeader) || reinterpret_cast<uintptr_t>(Data) % 8 != 0)
+    {
+        OutError = "Not a sheet cache";
+        return false;
+    }
+
+    const SheetCacheHeader* CandidateHeader = reinterpret_cast<const SheetCacheHeader*>(Data);
+    if (memcmp(CandidateHeader->Magic, SheetCacheMagic, sizeof(SheetCacheMagic)) != 0)
+    {
+        OutError = "Not a sheet cache";
+        return false;
+    }
+
+    if (CandidateHeader->Version != SheetCacheWriter::Version)
+    {
+        OutError = "Sheet cache version " + to_string(CandidateHeader->Version) + " is not supported";
+        return false;
+    }
+
+    const uint64_t RowCount = CandidateHeader->RowCount;
+    if (IsSection(sizeof(SheetCacheHeader), CandidateHeader->ColumnCount, sizeof(SheetCacheColumn)) == false
+        || IsSection(CandidateHeader->KeysOffset, RowCount, sizeof(uint32_t)) == false
+        || IsSection(CandidateHeader->StringOffsetsOffset, static_cast<uint64_t>(CandidateHeader->StringCount) + 1, sizeof(uint32_t)) == false
+        || CandidateHeader->StringBytesOffset > Size)
+    {
+        OutError = "Sheet cache is truncated";
+        return false;
+    }
+
+    const SheetCacheColumn* CandidateColumns = reinterpret_cast<const SheetCacheColumn*>(Data + sizeof(SheetCacheHeader));
+    for (uint32_t Column = 0; Column < CandidateHeader->ColumnCount; Column++)
+    {
+        const SheetCacheColumn& Desc = CandidateColumns[Column];
+        const bool bNumeric = Desc.Storage == ESheetCacheStorage::Int || Desc.Storage == ESheetCacheStorage::Real;
+        if ((bNumeric == false && Desc.Storage != ESheetCacheStorage::String)
+            || IsSection(Desc.DataOffset, RowCount, bNumeric ? sizeof(uint64_t) : sizeof(uint32_t)) == false)
+        {
+            OutError = "Sheet cache column " + to_string(Column) + " is corrupt";
+            return false;
+        }
+    }
+
+    const uint32_t* CandidateOffsets = reinterpret_cast<const uint32_t*>(Data + CandidateHeader->StringOffsetsOffset);
+    for (uint32_t Index = 0; Index < CandidateHeader->StringCount; Index++)
+    {
+        if (CandidateOffsets[Index] > CandidateOffsets[Index + 1])
+        {
+            OutError = "Sheet cache strings are corrupt";
+            return false;
+        }
+    }
+
+    if (CandidateOffsets[CandidateHeader->StringCount] > Size - CandidateHeader->StringBytesOffset)
+    {
+        OutError = "Sheet cache is truncated";
+        return false;
+    }
+
+    Header = CandidateHeader;
+    Columns = CandidateColumns;
+    Keys = reinterpret_cast<const uint32_t*>(Data + Header->KeysOffset);
+    StringOffsets = CandidateOffsets;
+    StringBytes = reinterpret_cast<const char*>(Data + Header->StringBytesOffset);
+    return true;
+}
+
+void SheetCache::AppendText(size_t InRow, size_t InColumn, string& OutText) const
+{
+    char Digits[32];
+    to_chars_result Result;
+
+    switch (GetColumnStorage(InColumn))
+    {
+    case ESheetCacheStorage::Int:
+        Result = to_chars(Digits, Digits + sizeof(Digits), GetInt(InRow, InColumn));
+        OutText.append(Digits, static_cast<size_t>(Result.ptr - Digits));
+        break;
+    case ESheetCacheStorage::Real:
+        Result = to_chars(Digits, Digits + sizeof(Digits), GetReal(InRow, InColumn));
+        OutText.append(Digits, static_cast<size_t>(Result.ptr - Digits));
+        break;
+    default:
+        OutText.append(GetString(InRow, InColumn));
+        break;
+    }
+}
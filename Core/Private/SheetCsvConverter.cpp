@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SheetCsvConverter.h"
+#include "SheetTableReader.h"
+#include "CsvFileWriter.h"
+#include "SheetCache.h"
+#include "DataTypeTokenTable.h"
+
+#include <fstream>
+
+using namespace std;
+
+// Header lines are a few hundred bytes, one chunk usually holds both
+static constexpr size_t SchemaReadChunkBytes = 4096;
+
+SheetCsvConverter::SheetCsvConverter()
+{
+}
+
+SheetCsvConverter::~SheetCsvConverter()
+{
+}
+
+bool SheetCsvConverter::Convert(const XlsxSheetReader& InReader, const string& InSheetName, const filesystem::path& OutCsvFilePath,
+    SheetCsvStats& OutStats, string& OutError, const atomic<bool>* InCancelFlag, const filesystem::path& OutSheetCachePath)
+{
+    OutStats = SheetCsvStats();
+
+    // Rows go straight to a temp file in UTF-8 through a fixed-size buffer, the target is replaced once the sheet is done
+    CsvFileWriter Writer;
+    if (Writer.Open(OutCsvFilePath) == false)
+    {
+        OutError = Writer.GetLastError();
+        return false;
+    }
+
+    // The cache takes the same rows as they stream past and spills them in blocks, so neither output holds the sheet.
+    // A cache that cannot be written does not fail the CSV, see SheetCsvStats::SheetCacheError.
+    SheetCacheWriter CacheWriter;
+    string CacheError;
+    const bool bWriteSheetCache = OutSheetCachePath.empty() == false && CacheWriter.Open(OutSheetCachePath, CacheError);
+
+    SheetTableStats TableStats;
+    SheetSchema Schema;
+    const bool bReadResult = SheetTableReader::ReadRows(InReader, InSheetName, [&Writer, &CacheWriter, &Schema, bWriteSheetCache](const SheetTableRow& InRow)
+    {
+        if (bWriteSheetCache)
+        {
+            CacheWriter.AddRow(InRow);
+        }
+        Schema.AddRow(InRow);
+
+        Writer.Append(InRow.Key);
+        if (InRow.GetCellCount() > 0)
+        {
+            Writer.Append(',');
+            Writer.Append(InRow.Text);
+        }
+        Writer.Append('\n');
+        return true;
+    }, TableStats, OutError, InCancelFlag);
+
+    if (bReadResult == false)
+    {
+        return false;
+    }
+
+    if (Writer.Commit() == false)
+    {
+        OutError = Writer.GetLastError();
+        return false;
+    }
+
+    // Committed after the CSV so a current cache is never older than it
+    if (bWriteSheetCache && CacheWriter.Commit(CacheError))
+    {
+        OutStats.bSheetCacheWritten = true;
+    }
+    else if (OutSheetCachePath.empty() == false)
+    {
+        // Whatever cache is left belongs to the previous CSV
+        error_code RemoveError;
+        filesystem::remove(OutSheetCachePath, RemoveError);
+        OutStats.SheetCacheError = move(CacheError);
+    }
+
+    OutStats.Rows = TableStats.Rows;
+    OutStats.DataRows = TableStats.DataRows;
+    OutStats.DataRowAllocations = TableStats.DataRowAllocations;
+    OutStats.OutputBytes = Writer.GetBytesWritten();
+    OutStats.OutputCrc = Writer.GetCrc32();
+    OutStats.Schema = move(Schema);
+    return true;
+}
+
+bool SheetCsvConverter::ReadSchema(const filesystem::path& InCsvFilePath, SheetSchema& OutSchema, string& OutError)
+{
+    OutSchema = SheetSchema();
+
+    ifstream File(InCsvFilePath, ios::binary);
+    if (File.is_open() == false)
+    {
+        OutError = "Failed to open " + InCsvFilePath.string();
+        return false;
+    }
+
+    // Read chunk by chunk until the second line break, the data rows are never touched
+    string Head;
+    size_t TypesEnd = string::npos;
+    size_t NamesEnd = string::npos;
+    while (NamesEnd == string::npos && File)
+    {
+        const size_t Used = Head.size();
+        Head.resize(Used + SchemaReadChunkBytes);
+        File.read(Head.data() + Used, static_cast<streamsize>(SchemaReadChunkBytes));
+        Head.resize(Used + static_cast<size_t>(File.gcount()));
+
+        if (TypesEnd == string::npos)
+        {
+            TypesEnd = Head.find('\n');
+        }
+        if (TypesEnd != string::npos)
+        {
+            NamesEnd = Head.find('\n', TypesEnd + 1);
+        }
+    }
+
+    // A table without data rows may end right after the names
+    if (TypesEnd == string::npos)
+    {
+        OutError = "Missing header lines in " + InCsvFilePath.string();
+        return false;
+    }
+    if (NamesEnd == string::npos)
+    {
+        NamesEnd = Head.size();
+    }
+
+    // Each line is "Key,<cells>" : the key column is not part of the schema
+    auto SplitLine = [](string_view InLine, vector<string>& OutCells)
+    {
+        if (InLine.empty() == false && InLine.back() == '\r')
+        {
+            InLine.remove_suffix(1);
+        }
+
+        const size_t FirstComma = InLine.find(',');
+        if (FirstComma == string_view::npos)
+        {
+            return;
+        }
+
+        InLine.remove_prefix(FirstComma + 1);
+        for (size_t Comma = InLine.find(','); Comma != string_view::npos; Comma = InLine.find(','))
+        {
+            OutCells.emplace_back(InLine.substr(0, Comma));
+            InLine.remove_prefix(Comma + 1);
+        }
+        OutCells.emplace_back(InLine);
+    };
+
+    const string_view HeadView(Head);
+    SplitLine(HeadView.substr(0, TypesEnd), OutSchema.Types);
+    SplitLine(HeadView.substr(TypesEnd + 1, NamesEnd - TypesEnd - 1), OutSchema.Names);
+
+    if (OutSchema.IsValid() == false)
+    {
+        OutError = "Mismatched header lines in " + InCsvFilePath.string();
+        return false;
+    }
+
+    return true;
+}
+
+bool SheetCsvConverter::IsDataTypeToken(string_view InToken)
+{
+    return DataTypeTokenTable::Contains(InToken);
+}
@@ -0,0 +1,278 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SheetTableReader.h"
+#include "AllocationCounter.h"
+#include "CsvCellFormatter.h"
+#include "DataTypeTokenTable.h"
+
+#include <charconv>
+
+using namespace std;
+
+// Row buffer room per column once the header row is known
+static constexpr size_t EstimatedCellBytes = 32;
+
+SheetTableReader::SheetTableReader()
+{
+}
+
+SheetTableReader::~SheetTableReader()
+{
+}
+
+void SheetSchema::AddRow(const SheetTableRow& InRow)
+{
+    if (InRow.Kind == ESheetRowKind::Data)
+    {
+        return;
+    }
+
+    vector<string>& Header = InRow.Kind == ESheetRowKind::Types ? Types : Names;
+    Header.clear();
+    for (size_t Index = 0; Index < InRow.GetCellCount(); Index++)
+    {
+        Header.emplace_back(InRow.GetCell(Index));
+    }
+    KeyColumn = InRow.KeyColumn;
+}
+
+void SheetTable::Reset()
+{
+    Types.clear();
+    Names.clear();
+    Text.clear();
+    CellEnds.clear();
+    RowFirstCell.clear();
+}
+
+void SheetTable::AddRow(const SheetTableRow& InRow)
+{
+    if (InRow.Kind != ESheetRowKind::Data)
+    {
+        vector<string>& Header = InRow.Kind == ESheetRowKind::Types ? Types : Names;
+        Header.clear();
+        for (size_t Index = 0; Index < InRow.GetCellCount(); Index++)
+        {
+            Header.emplace_back(InRow.GetCell(Index));
+        }
+        return;
+    }
+
+    if (RowFirstCell.empty())
+    {
+        RowFirstCell.push_back(0);
+    }
+
+    Text.append(InRow.Key);
+    CellEnds.push_back(static_cast<uint32_t>(Text.size()));
+    for (size_t Index = 0; Index < InRow.GetCellCount(); Index++)
+    {
+        Text.append(InRow.GetCell(Index));
+        CellEnds.push_back(static_cast<uint32_t>(Text.size()));
+    }
+
+    RowFirstCell.push_back(static_cast<uint32_t>(CellEnds.size()));
+}
+
+void SheetTable::ShrinkToFit()
+{
+    Text.shrink_to_fit();
+    CellEnds.shrink_to_fit();
+    RowFirstCell.shrink_to_fit();
+}
+
+size_t SheetTable::GetMemoryFootprint() const
+{
+    return Text.capacity() + CellEnds.capacity() * sizeof(uint32_t) + RowFirstCell.capacity() * sizeof(uint32_t);
+}
+
+bool SheetTableReader::ReadRows(const XlsxSheetReader& InReader, const string& InSheetName, const RowCallback& InCallback,
+    SheetTableStats& OutStats, string& OutError, const atomic<bool>* InCancelFlag)
+{
+    OutStats = SheetTableStats();
+
+    // Reused for every row : after the first rows they have enough capacity and data rows allocate nothing
+    string RowBuffer;
+    string HeaderCellBuffer;
+    vector<size_t> CellBegins;
+    RowBuffer.reserve(4096);
+    HeaderCellBuffer.reserve(256);
+
+    char KeyDigits[16];
+
+    int RowNum = 0;
+    int StartRow = -1;
+    int StartCell = -1;
+    int KeyCell = -1;
+    int KeyValue = 1;
+
+    // A row's allocations run from the end of the previous row, so the XML parsing of the row is counted with it
+    uint64_t RowAllocationsStart = AllocationCounter::Read();
+
+    // Same header detection and KEY handling as the XLWorksheet overload in XlsxManager, fed row by row from the sheet XML
+    string ReadError;
+    bool bCancelled = false;
+    bool bStopped = false;
+    bool bReadResult = InReader.ReadRows(InSheetName, [&](const XlsxRow& Row)
+    {
+        if (InCancelFlag != nullptr && InCancelFlag->load(memory_order_relaxed))
+        {
+            bCancelled = true;
+            return false;
+        }
+
+        // The '=' split is only needed until the header row is found and on the header row itself
+        const bool bHeaderScan = StartRow == -1 || RowNum == StartRow;
+
+        RowBuffer.clear();
+        CellBegins.clear();
+
+        // The key column is written once into RowBuffer and handed out from there, rows shorter than it get an empty key
+        size_t KeyBegin = 0;
+        size_t KeyLength = 0;
+        int CellNum = 0;
+
+        for (const XlsxCell& Cell : Row.Cells)
+        {
+            const size_t ValueBegin = RowBuffer.size() + (CellBegins.empty() ? 0 : 1);
+            string_view FirstToken;
+            bool bHasToken = false;
+
+            if (bHeaderScan)
+            {
+                // Header cells are short, format them on their own to split
+                HeaderCellBuffer.clear();
+                CsvCellFormatter::AppendValue(Cell, HeaderCellBuffer);
+
+                CsvCellFormatter::ForEachHeaderToken(HeaderCellBuffer, [&](string_view Parse)
+                {
+                    if (bHasToken == false)
+                    {
+                        FirstToken = Parse;
+                        bHasToken = true;
+                    }
+
+                    if (StartRow == -1 && DataTypeTokenTable::Contains(Parse))
+                    {
+                        StartRow = RowNum;
+                        StartCell = CellNum;
+                    }
+
+                    if (Parse == "KEY" && RowNum == StartRow)
+                    {
+                        KeyCell = CellNum;
+                    }
+                });
+            }
+
+            if (StartRow <= RowNum && StartCell <= CellNum && StartRow != -1 && StartCell != -1)
+            {
+                if (CellBegins.empty() == false)
+                {
+                    RowBuffer.push_back(',');
+                }
+                CellBegins.push_back(ValueBegin);
+
+                if (bHeaderScan)
+                {
+                    RowBuffer.append(bHasToken ? FirstToken : string_view(HeaderCellBuffer));
+                }
+                else
+                {
+                    CsvCellFormatter::AppendValue(Cell, RowBuffer);
+                }
+
+                if (CellNum == KeyCell && bHeaderScan == false)
+                {
+                    KeyBegin = ValueBegin;
+                    KeyLength = RowBuffer.size() - ValueBegin;
+                }
+            }
+
+            CellNum++;
+        }
+
+        if (StartRow <= RowNum && StartRow != -1)
+        {
+            SheetTableRow TableRow;
+            TableRow.Text = RowBuffer;
+            TableRow.CellBegins = &CellBegins;
+            TableRow.KeyColumn = KeyCell == -1 ? -1 : KeyCell - StartCell;
+
+            if (StartRow == RowNum || StartRow == RowNum - 1)
+            {
+                TableRow.Kind = StartRow == RowNum ? ESheetRowKind::Types : ESheetRowKind::Names;
+                TableRow.Key = "Key";
+            }
+            else if (KeyCell == -1)
+            {
+                const to_chars_result Result = to_chars(KeyDigits, KeyDigits + sizeof(KeyDigits), KeyValue);
+                TableRow.Key = string_view(KeyDigits, static_cast<size_t>(Result.ptr - KeyDigits));
+            }
+            else
+            {
+                TableRow.Key = string_view(RowBuffer).substr(KeyBegin, KeyLength);
+            }
+
+            if (InCallback(TableRow) == false)
+            {
+                bStopped = true;
+                return false;
+            }
+
+            if (bHeaderScan == false)
+            {
+                OutStats.DataRows++;
+                const uint64_t RowAllocationsEnd = AllocationCounter::Read();
+                OutStats.DataRowAllocations += RowAllocationsEnd - RowAllocationsStart;
+                RowAllocationsStart = RowAllocationsEnd;
+            }
+            else if (RowNum == StartRow)
+            {
+                // The header fixes the column count : size the row buffer once for wide sheets instead of growing it on data rows
+                RowBuffer.reserve(CellBegins.size() * EstimatedCellBytes);
+            }
+        }
+
+        // Header rows and the rows above them are left out of the count
+        if (bHeaderScan)
+        {
+            RowAllocationsStart = AllocationCounter::Read();
+        }
+
+        RowNum++;
+        return true;
+    }, &ReadError);
+
+    OutStats.Rows = RowNum;
+
+    if (bCancelled)
+    {
+        OutError = "Cancelled";
+        return false;
+    }
+
+    if (bReadResult == false && bStopped == false)
+    {
+        OutError = "Failed to read sheet " + InSheetName + " : " + ReadError;
+        return false;
+    }
+
+    return true;
+}
+
+bool SheetTableReader::Load(const XlsxSheetReader& InReader, const string& InSheetName, SheetTable& OutTable,
+    SheetTableStats& OutStats, string& OutError, const atomic<bool>* InCancelFlag)
+{
+    OutTable.Reset();
+
+    const bool bResult = ReadRows(InReader, InSheetName, [&OutTable](const SheetTableRow& InRow)
+    {
+        OutTable.AddRow(InRow);
+        return true;
+    }, OutStats, OutError, InCancelFlag);
+
+    // Loaded tables wait in a queue for the game thread, keep only what they use
+    OutTable.ShrinkToFit();
+    return bResult;
+}
@@ -0,0 +1,462 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "XlsxArchive.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "zlib.h"
+
+using namespace std;
+
+namespace
+{
+    constexpr uint32_t LocalHeaderSignature = 0x04034b50;
+    constexpr uint32_t CentralHeaderSignature = 0x02014b50;
+    constexpr uint32_t EndOfCentralDirSignature = 0x06054b50;
+    constexpr uint32_t Zip64EndOfCentralDirSignature = 0x06064b50;
+    constexpr uint32_t Zip64LocatorSignature = 0x07064b50;
+
+    constexpr size_t EndOfCentralDirSize = 22;
+    constexpr size_t Zip64LocatorSize = 20;
+    constexpr size_t CentralHeaderSize = 46;
+    constexpr size_t LocalHeaderSize = 30;
+    constexpr size_t MaxCommentSize = 0xFFFF;
+
+    constexpr size_t InputChunkSize = 64 * 1024;
+
+    constexpr uint16_t MethodStored = 0;
+    constexpr uint16_t MethodDeflated = 8;
+
+    uint16_t ReadU16(const unsigned char* InData)
+    {
+        return static_cast<uint16_t>(InData[0] | (InData[1] << 8));
+    }
+
+    uint32_t ReadU32(const unsigned char* InData)
+    {
+        return static_cast<uint32_t>(InData[0]) | (static_cast<uint32_t>(InData[1]) << 8) | (static_cast<uint32_t>(InData[2]) << 16) | (static_cast<uint32_t>(InData[3]) << 24);
+    }
+
+    uint64_t ReadU64(const unsigned char* InData)
+    {
+        return static_cast<uint64_t>(ReadU32(InData)) | (static_cast<uint64_t>(ReadU32(InData + 4)) << 32);
+    }
+
+    bool ReadAt(ifstream& InFile, uint64_t InOffset, void* OutData, size_t InSize)
+    {
+        InFile.clear();
+        InFile.seekg(static_cast<streamoff>(InOffset), ios::beg);
+        InFile.read(static_cast<char*>(OutData), static_cast<streamsize>(InSize));
+        return InFile.gcount() == static_cast<streamsize>(InSize);
+    }
+}
+
+struct XlsxArchive::EntryStream::InflateState
+{
+    z_stream Stream;
+    bool bInitialized = false;
+
+    InflateState()
+    {
+        memset(&Stream, 0, sizeof(Stream));
+    }
+
+    ~InflateState()
+    {
+        if (bInitialized)
+        {
+            inflateEnd(&Stream);
+        }
+    }
+};
+
+XlsxArchive::EntryStream::EntryStream()
+{
+}
+
+XlsxArchive::EntryStream::~EntryStream()
+{
+}
+
+bool XlsxArchive::EntryStream::Open(const filesystem::path& InArchivePath, const Entry& InEntry)
+{
+    Source = InEntry;
+    Inflater.reset();
+    RemainingInput = 0;
+    Produced = 0;
+    RunningCrc = static_cast<uint32_t>(crc32(0L, Z_NULL, 0));
+    bFinished = false;
+    bError = true;
+
+    if (InEntry.Method != MethodStored && InEntry.Method != MethodDeflated)
+    {
+        return false;
+    }
+
+    File.close();
+    File.open(InArchivePath, ios::binary);
+    if (File.is_open() == false)
+    {
+        return false;
+    }
+
+    unsigned char Header[LocalHeaderSize];
+    if (ReadAt(File, InEntry.LocalHeaderOffset, Header, LocalHeaderSize) == false || ReadU32(Header) != LocalHeaderSignature)
+    {
+        return false;
+    }
+
+    const uint64_t DataOffset = InEntry.LocalHeaderOffset + LocalHeaderSize + ReadU16(Header + 26) + ReadU16(Header + 28);
+    File.clear();
+    File.seekg(static_cast<streamoff>(DataOffset), ios::beg);
+
+    RemainingInput = InEntry.CompressedSize;
+    InputBuffer.resize(InputChunkSize);
+
+    if (InEntry.Method == MethodDeflated)
+    {
+        Inflater = make_unique<InflateState>();
+        // Negative window bits : raw deflate data without zlib header, as stored in zip entries
+        if (inflateInit2(&Inflater->Stream, -MAX_WBITS) != Z_OK)
+        {
+            return false;
+        }
+        Inflater->bInitialized = true;
+    }
+
+    bError = false;
+    return true;
+}
+
+bool XlsxArchive::EntryStream::FillInput()
+{
+    if (RemainingInput == 0)
+    {
+        return false;
+    }
+
+    const size_t ToRead = static_cast<size_t>(min<uint64_t>(RemainingInput, InputBuffer.size()));
+    File.read(InputBuffer.data(), static_cast<streamsize>(ToRead));
+    if (File.gcount() != static_cast<streamsize>(ToRead))
+    {
+        bError = true;
+        return false;
+    }
+
+    RemainingInput -= ToRead;
+    Inflater->Stream.next_in = reinterpret_cast<Bytef*>(InputBuffer.data());
+    Inflater->Stream.avail_in = static_cast<uInt>(ToRead);
+    return true;
+}
+
+size_t XlsxArchive::EntryStream::Read(char* OutBuffer, size_t InSize)
+{
+    if (bFinished || bError || InSize == 0)
+    {
+        return 0;
+    }
+
+    size_t Written = 0;
+
+    if (Source.Method == MethodStored)
+    {
+        const size_t ToRead = static_cast<size_t>(min<uint64_t>(RemainingInput, InSize));
+        if (ToRead > 0)
+        {
+            File.read(OutBuffer, static_cast<streamsize>(ToRead));
+            if (File.gcount() != static_cast<streamsize>(ToRead))
+            {
+                bError = true;
+                return 0;
+            }
+            RemainingInput -= ToRead;
+        }
+        Written = ToRead;
+        bFinished = RemainingInput == 0;
+    }
+    else
+    {
+        z_stream& Stream = Inflater->Stream;
+        Stream.next_out = reinterpret_cast<Bytef*>(OutBuffer);
+        Stream.avail_out = static_cast<uInt>(InSize);
+
+        while (Stream.avail_out > 0)
+        {
+            if (Stream.avail_in == 0 && FillInput() == false && bError)
+            {
+                break;
+            }
+
+            // With no input left, inflate may still flush bits it already holds, so it is called once more
+            const int Result = inflate(&Stream, Z_NO_FLUSH);
+            if (Result == Z_STREAM_END)
+            {
+                bFinished = true;
+                break;
+            }
+            if (Result != Z_OK)
+            {
+                bError = true;
+                break;
+            }
+        }
+
+        Written = InSize - Stream.avail_out;
+    }
+
+    if (bError)
+    {
+        return 0;
+    }
+
+    Produced += Written;
+    RunningCrc = static_cast<uint32_t>(crc32(RunningCrc, reinterpret_cast<const Bytef*>(OutBuffer), static_cast<uInt>(Written)));
+
+    if (bFinished && (Produced != Source.UncompressedSize || RunningCrc != Source.Crc32))
+    {
+        bError = true;
+        return 0;
+    }
+
+    return Written;
+}
+
+bool XlsxArchive::Open(const filesystem::path& InArchivePath)
+{
+    Close();
+
+    ifstream File(InArchivePath, ios::binary);
+    if (File.is_open() == false)
+    {
+        LastError = "Failed to open file";
+        return false;
+    }
+
+    if (ReadCentralDirectory(File) == false)
+    {
+        Entries.clear();
+        EntryIndex.clear();
+        return false;
+    }
+
+    ArchivePath = InArchivePath;
+    bOpened = true;
+    return true;
+}
+
+void XlsxArchive::Close()
+{
+    ArchivePath.clear();
+    Entries.clear();
+    EntryIndex.clear();
+    LastError.clear();
+    bOpened = false;
+}
+
+bool XlsxArchive::ReadCentralDirectory(ifstream& InFile)
+{
+    InFile.seekg(0, ios::end);
+    const uint64_t FileSize = static_cast<uint64_t>(InFile.tellg());
+    if (FileSize < EndOfCentralDirSize)
+    {
+        LastError = "File is too small to be a zip archive";
+        return false;
+    }
+
+    // The end of central directory record sits at the very end, followed only by an optional comment
+    const size_t TailSize = static_cast<size_t>(min<uint64_t>(FileSize, EndOfCentralDirSize + MaxCommentSize));
+    vector<unsigned char> Tail(TailSize);
+    if (ReadAt(InFile, FileSize - TailSize, Tail.data(), TailSize) == false)
+    {
+        LastError = "Failed to read zip trailer";
+        return false;
+    }
+
+    size_t EndRecord = string::npos;
+    for (size_t Pos = TailSize - EndOfCentralDirSize + 1; Pos-- > 0;)
+    {
+        if (ReadU32(Tail.data() + Pos) == EndOfCentralDirSignature)
+        {
+            EndRecord = Pos;
+            break;
+        }
+    }
+
+    if (EndRecord == string::npos)
+    {
+        LastError = "Zip end of central directory not found";
+        return false;
+    }
+
+    const unsigned char* Record = Tail.data() + EndRecord;
+    uint64_t EntryCount = ReadU16(Record + 10);
+    uint64_t DirectorySize = ReadU32(Record + 12);
+    uint64_t DirectoryOffset = ReadU32(Record + 16);
+
+    if (EntryCount == 0xFFFF || DirectorySize == 0xFFFFFFFF || DirectoryOffset == 0xFFFFFFFF)
+    {
+        const uint64_t EndRecordOffset = FileSize - TailSize + EndRecord;
+        unsigned char Locator[Zip64LocatorSize];
+        if (EndRecordOffset < Zip64LocatorSize || ReadAt(InFile, EndRecordOffset - Zip64LocatorSize, Locator, Zip64LocatorSize) == false || ReadU32(Locator) != Zip64LocatorSignature)
+        {
+            LastError = "Zip64 locator not found";
+            return false;
+        }
+
+        unsigned char Zip64Record[56];
+        if (ReadAt(InFile, ReadU64(Locator + 8), Zip64Record, sizeof(Zip64Record)) == false || ReadU32(Zip64Record) != Zip64EndOfCentralDirSignature)
+        {
+            LastError = "Zip64 end of central directory not found";
+            return false;
+        }
+
+        EntryCount = ReadU64(Zip64Record + 32);
+        DirectorySize = ReadU64(Zip64Record + 40);
+        DirectoryOffset = ReadU64(Zip64Record + 48);
+    }
+
+    if (DirectoryOffset + DirectorySize > FileSize)
+    {
+        LastError = "Zip central directory is out of range";
+        return false;
+    }
+
+    vector<unsigned char> Directory(static_cast<size_t>(DirectorySize));
+    if (ReadAt(InFile, DirectoryOffset, Directory.data(), Directory.size()) == false)
+    {
+        LastError = "Failed to read zip central directory";
+        return false;
+    }
+
+    Entries.reserve(static_cast<size_t>(EntryCount));
+
+    size_t Pos = 0;
+    for (uint64_t Num = 0; Num < EntryCount; Num++)
+    {
+        if (Pos + CentralHeaderSize > Directory.size() || ReadU32(Directory.data() + Pos) != CentralHeaderSignature)
+        {
+            LastError = "Corrupted zip central directory";
+            return false;
+        }
+
+        const unsigned char* Header = Directory.data() + Pos;
+        const uint16_t NameLength = ReadU16(Header + 28);
+        const uint16_t ExtraLength = ReadU16(Header + 30);
+        const uint16_t CommentLength = ReadU16(Header + 32);
+
+        if (Pos + CentralHeaderSize + NameLength + ExtraLength + CommentLength > Directory.size())
+        {
+            LastError = "Corrupted zip central directory";
+            return false;
+        }
+
+        Entry NewEntry;
+        NewEntry.Method = ReadU16(Header + 10);
+        NewEntry.Crc32 = ReadU32(Header + 16);
+        NewEntry.CompressedSize = ReadU32(Header + 20);
+        NewEntry.UncompressedSize = ReadU32(Header + 24);
+        NewEntry.LocalHeaderOffset = ReadU32(Header + 42);
+        NewEntry.Name.assign(reinterpret_cast<const char*>(Header + CentralHeaderSize), NameLength);
+
+        // Zip64 extended information : only the fields saturated in the fixed header are present, in this order
+        const unsigned char* Extra = Header + CentralHeaderSize + NameLength;
+        const unsigned char* ExtraEnd = Extra + ExtraLength;
+        while (Extra + 4 <= ExtraEnd)
+        {
+            const uint16_t FieldId = ReadU16(Extra);
+            const uint16_t FieldSize = ReadU16(Extra + 2);
+            const unsigned char* Field = Extra + 4;
+            const unsigned char* FieldEnd = min(Field + FieldSize, ExtraEnd);
+
+            if (FieldId == 0x0001)
+            {
+                if (NewEntry.UncompressedSize == 0xFFFFFFFF && Field + 8 <= FieldEnd)
+                {
+                    NewEntry.UncompressedSize = ReadU64(Field);
+                    Field += 8;
+                }
+                if (NewEntry.CompressedSize == 0xFFFFFFFF && Field + 8 <= FieldEnd)
+                {
+                    NewEntry.CompressedSize = ReadU64(Field);
+                    Field += 8;
+                }
+                if (NewEntry.LocalHeaderOffset == 0xFFFFFFFF && Field + 8 <= FieldEnd)
+                {
+                    NewEntry.LocalHeaderOffset = ReadU64(Field);
+                }
+            }
+
+            Extra += 4 + FieldSize;
+        }
+
+        EntryIndex.emplace(NewEntry.Name, Entries.size());
+        Entries.push_back(move(NewEntry));
+
+        Pos += CentralHeaderSize + NameLength + ExtraLength + CommentLength;
+    }
+
+    return true;
+}
+
+const XlsxArchive::Entry* XlsxArchive::FindEntry(const string& InName) const
+{
+    // Part names inside the package are stored without a leading slash
+    const string& Name = (InName.empty() == false && InName[0] == '/') ? InName.substr(1) : InName;
+
+    auto Found = EntryIndex.find(Name);
+    if (Found == EntryIndex.end())
+    {
+        return nullptr;
+    }
+
+    return &Entries[Found->second];
+}
+
+bool XlsxArchive::OpenEntry(const string& InName, EntryStream& OutStream) const
+{
+    const Entry* Found = FindEntry(InName);
+    if (Found == nullptr)
+    {
+        return false;
+    }
+
+    return OutStream.Open(ArchivePath, *Found);
+}
+
+bool XlsxArchive::ReadEntry(const string& InName, string& OutData) const
+{
+    const Entry* Found = FindEntry(InName);
+    if (Found == nullptr)
+    {
+        return false;
+    }
+
+    EntryStream Stream;
+    if (Stream.Open(ArchivePath, *Found) == false)
+    {
+        return false;
+    }
+
+    OutData.resize(static_cast<size_t>(Found->UncompressedSize));
+
+    size_t Offset = 0;
+    while (Offset < OutData.size())
+    {
+        const size_t Read = Stream.Read(&OutData[Offset], OutData.size() - Offset);
+        if (Read == 0)
+        {
+            break;
+        }
+        Offset += Read;
+    }
+
+    // Drain so the stream validates size and CRC at the end of the entry
+    char Probe;
+    if (Stream.IsFinished() == false)
+    {
+        Stream.Read(&Probe, 1);
+    }
+
+    return Offset == OutData.size() && Stream.IsFinished() && Stream.HasError() == false;
+}
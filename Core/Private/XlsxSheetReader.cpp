@@ -0,0 +1,711 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "XlsxSheetReader.h"
+#include "XmlPullParser.h"
+
+#include <charconv>
+#include <cstdlib>
+#include <unordered_map>
+
+using namespace std;
+
+namespace
+{
+    using EEvent = XmlPullParser::EEvent;
+
+    const string DefaultWorkbookPart = "xl/workbook.xml";
+
+    bool EndsWith(string_view InStr, string_view InSuffix)
+    {
+        return InStr.size() >= InSuffix.size() && InStr.compare(InStr.size() - InSuffix.size(), InSuffix.size(), InSuffix) == 0;
+    }
+
+    string GetRelationshipsPart(const string& InPartName)
+    {
+        const size_t Slash = InPartName.rfind('/');
+        const string Folder = Slash == string::npos ? string() : InPartName.substr(0, Slash + 1);
+        const string File = Slash == string::npos ? InPartName : InPartName.substr(Slash + 1);
+
+        return Folder + "_rels/" + File + ".rels";
+    }
+
+    // Relationship targets are relative to the folder of the source part unless they start with '/'
+    string ResolveTarget(const string& InSourcePart, string_view InTarget)
+    {
+        string Combined;
+        if (InTarget.empty() == false && InTarget[0] == '/')
+        {
+            Combined.assign(InTarget.substr(1));
+        }
+        else
+        {
+            const size_t Slash = InSourcePart.rfind('/');
+            Combined = (Slash == string::npos ? string() : InSourcePart.substr(0, Slash + 1)) + string(InTarget);
+        }
+
+        vector<string> Segments;
+        size_t Begin = 0;
+        while (Begin <= Combined.size())
+        {
+            size_t End = Combined.find('/', Begin);
+            if (End == string::npos)
+            {
+                End = Combined.size();
+            }
+
+            const string Segment = Combined.substr(Begin, End - Begin);
+            if (Segment == "..")
+            {
+                if (Segments.empty() == false)
+                {
+                    Segments.pop_back();
+                }
+            }
+            else if (Segment.empty() == false && Segment != ".")
+            {
+                Segments.push_back(Segment);
+            }
+
+            Begin = End + 1;
+        }
+
+        string Result;
+        for (const string& Segment : Segments)
+        {
+            if (Result.empty() == false)
+            {
+                Result += '/';
+            }
+            Result += Segment;
+        }
+
+        return Result;
+    }
+
+    // Collects Id -> (Type, Target) of a .rels part
+    bool ReadRelationships(const XlsxArchive& InArchive, const string& InRelsPart, unordered_map<string, pair<string, string>>& OutRelationships)
+    {
+        string Xml;
+        if (InArchive.ReadEntry(InRelsPart, Xml) == false)
+        {
+            return false;
+        }
+
+        XmlPullParser Parser(Xml);
+        for (EEvent Event = Parser.Next(); Event != EEvent::EndOfDocument; Event = Parser.Next())
+        {
+            if (Event == EEvent::Error)
+            {
+                return false;
+            }
+
+            if (Event != EEvent::StartElement || Parser.GetLocalName() != "Relationship")
+            {
+                continue;
+            }
+
+            string_view Id, Type, Target;
+            if (Parser.FindAttribute("Id", Id) && Parser.FindAttribute("Type", Type) && Parser.FindAttribute("Target", Target))
+            {
+                string DecodedId, DecodedTarget;
+                XmlPullParser::AppendDecoded(Id, DecodedId);
+                XmlPullParser::AppendDecoded(Target, DecodedTarget);
+                OutRelationships[DecodedId] = make_pair(string(Type), DecodedTarget);
+            }
+        }
+
+        return true;
+    }
+
+    // "AB12" -> 28
+    uint32_t ColumnFromReference(string_view InReference)
+    {
+        uint32_t Column = 0;
+        for (const char Char : InReference)
+        {
+            if (Char >= 'A' && Char <= 'Z')
+            {
+                Column = Column * 26 + (Char - 'A' + 1);
+            }
+            else if (Char >= 'a' && Char <= 'z')
+            {
+                Column = Column * 26 + (Char - 'a' + 1);
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        return Column;
+    }
+
+    uint32_t ParseUnsigned(string_view InText)
+    {
+        uint32_t Value = 0;
+        from_chars(InText.data(), InText.data() + InText.size(), Value);
+        return Value;
+    }
+
+    // Same classification as OpenXLSX : a number is a float when its text has a '.' or an exponent
+    void AssignNumber(string_view InText, XlsxCell& OutCell)
+    {
+        if (InText.empty())
+        {
+            OutCell.Type = EXlsxCellType::Empty;
+            return;
+        }
+
+        if (InText.find_first_of(".eE") == string_view::npos)
+        {
+            int64_t Value = 0;
+            const from_chars_result Result = from_chars(InText.data(), InText.data() + InText.size(), Value);
+            if (Result.ec == errc() && Result.ptr == InText.data() + InText.size())
+            {
+                OutCell.Type = EXlsxCellType::Integer;
+                OutCell.IntValue = Value;
+                return;
+            }
+        }
+
+        // strtod needs a terminated string, numbers are short enough for a stack copy
+        char Terminated[64];
+        const size_t Length = InText.size() < sizeof(Terminated) - 1 ? InText.size() : sizeof(Terminated) - 1;
+        InText.copy(Terminated, Length);
+        Terminated[Length] = '\0';
+
+        OutCell.Type = EXlsxCellType::Float;
+        OutCell.FloatValue = strtod(Terminated, nullptr);
+    }
+}
+
+XlsxSheetReader::XlsxSheetReader()
+{
+}
+
+XlsxSheetReader::~XlsxSheetReader()
+{
+}
+
+bool XlsxSheetReader::Open(const filesystem::path& InXlsxFilePath)
+{
+    Close();
+
+    if (Archive.Open(InXlsxFilePath) == false)
+    {
+        LastError = Archive.GetLastError();
+        return false;
+    }
+
+    if (ReadWorkbook() == false)
+    {
+        Archive.Close();
+        return false;
+    }
+
+    // Entries and sheet names do not change once open, the shared strings add theirs when they load
+    size_t Bytes = sizeof(XlsxSheetReader);
+    for (const XlsxArchive::Entry& Entry : Archive.GetEntries())
+    {
+        Bytes += sizeof(Entry) + Entry.Name.capacity();
+    }
+    for (size_t Index = 0; Index < SheetNames.size(); Index++)
+    {
+        Bytes += SheetNames[Index].capacity() + SheetParts[Index].capacity();
+    }
+    MemoryFootprint = Bytes;
+
+    return true;
+}
+
+void XlsxSheetReader::Close()
+{
+    Archive.Close();
+    SheetNames.clear();
+    SheetParts.clear();
+    SharedStringsPart.clear();
+    SharedStrings.clear();
+    bSharedStringsLoaded = false;
+    MemoryFootprint = 0;
+    LastError.clear();
+}
+
+bool XlsxSheetReader::ReadWorkbook()
+{
+    // The package relationships point at the workbook part, which is xl/workbook.xml in practice
+    string WorkbookPart = DefaultWorkbookPart;
+
+    unordered_map<string, pair<string, string>> PackageRelationships;
+    if (ReadRelationships(Archive, "_rels/.rels", PackageRelationships))
+    {
+        for (const auto& Relationship : PackageRelationships)
+        {
+            if (EndsWith(Relationship.second.first, "/officeDocument"))
+            {
+                WorkbookPart = ResolveTarget("", Relationship.second.second);
+                break;
+            }
+        }
+    }
+
+    unordered_map<string, pair<string, string>> WorkbookRelationships;
+    if (ReadRelationships(Archive, GetRelationshipsPart(WorkbookPart), WorkbookRelationships) == false)
+    {
+        LastError = "Failed to read workbook relationships";
+        return false;
+    }
+
+    for (const auto& Relationship : WorkbookRelationships)
+    {
+        if (EndsWith(Relationship.second.first, "/sharedStrings"))
+        {
+            SharedStringsPart = ResolveTarget(WorkbookPart, Relationship.second.second);
+        }
+    }
+
+    string Xml;
+    if (Archive.ReadEntry(WorkbookPart, Xml) == false)
+    {
+        LastError = "Failed to read " + WorkbookPart;
+        return false;
+    }
+
+    XmlPullParser Parser(Xml);
+    for (EEvent Event = Parser.Next(); Event != EEvent::EndOfDocument; Event = Parser.Next())
+    {
+        if (Event == EEvent::Error)
+        {
+            LastError = "Malformed " + WorkbookPart;
+            return false;
+        }
+
+        if (Event != EEvent::StartElement || Parser.GetLocalName() != "sheet")
+        {
+            continue;
+        }
+
+        string_view Name, RelationshipId;
+        if (Parser.FindAttribute("name", Name) == false || Parser.FindAttribute("id", RelationshipId) == false)
+        {
+            continue;
+        }
+
+        string DecodedId;
+        XmlPullParser::AppendDecoded(RelationshipId, DecodedId);
+
+        // Chart sheets and dialog sheets are listed too, but only worksheets hold cell data
+        auto Found = WorkbookRelationships.find(DecodedId);
+        if (Found == WorkbookRelationships.end() || EndsWith(Found->second.first, "/worksheet") == false)
+        {
+            continue;
+        }
+
+        string DecodedName;
+        XmlPullParser::AppendDecoded(Name, DecodedName);
+
+        SheetNames.push_back(move(DecodedName));
+        SheetParts.push_back(ResolveTarget(WorkbookPart, Found->second.second));
+    }
+
+    return true;
+}
+
+bool XlsxSheetReader::LoadSharedStrings(string& OutError) const
+{
+    lock_guard<mutex> Lock(SharedStringsMutex);
+
+    if (bSharedStringsLoaded)
+    {
+        return true;
+    }
+
+    if (SharedStringsPart.empty())
+    {
+        bSharedStringsLoaded = true;
+        return true;
+    }
+
+    XlsxArchive::EntryStream Stream;
+    if (Archive.OpenEntry(SharedStringsPart, Stream) == false)
+    {
+        OutError = "Failed to open " + SharedStringsPart;
+        return false;
+    }
+
+    vector<string> Strings;
+    string Current;
+    bool bInItem = false;
+    bool bInText = false;
+    int PhoneticDepth = 0;
+
+    XmlPullParser Parser(Stream);
+    for (EEvent Event = Parser.Next(); Event != EEvent::EndOfDocument; Event = Parser.Next())
+    {
+        switch (Event)
+        {
+        case EEvent::Error:
+            OutError = "Malformed " + SharedStringsPart;
+            return false;
+
+        case EEvent::StartElement:
+        {
+            const string_view Name = Parser.GetLocalName();
+            if (Name == "sst")
+            {
+                string_view UniqueCount;
+                if (Parser.FindAttribute("uniqueCount", UniqueCount))
+                {
+                    Strings.reserve(ParseUnsigned(UniqueCount));
+                }
+            }
+            else if (Name == "si")
+            {
+                bInItem = true;
+                Current.clear();
+            }
+            else if (Name == "rPh")
+            {
+                PhoneticDepth++;
+            }
+            else if (Name == "t")
+            {
+                bInText = bInItem && PhoneticDepth == 0;
+            }
+            break;
+        }
+
+        case EEvent::EndElement:
+        {
+            const string_view Name = Parser.GetLocalName();
+            if (Name == "si")
+            {
+                bInItem = false;
+                Strings.push_back(Current);
+            }
+            else if (Name == "rPh")
+            {
+                PhoneticDepth--;
+            }
+            else if (Name == "t")
+            {
+                bInText = false;
+            }
+            break;
+        }
+
+        case EEvent::Text:
+            if (bInText)
+            {
+                if (Parser.IsCData())
+                {
+                    Current.append(Parser.GetText());
+                }
+                else
+                {
+                    XmlPullParser::AppendDecoded(Parser.GetText(), Current);
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    size_t Bytes = Strings.capacity() * sizeof(string);
+    for (const string& Text : Strings)
+    {
+        Bytes += Text.capacity();
+    }
+
+    SharedStrings = move(Strings);
+    bSharedStringsLoaded = true;
+    MemoryFootprint += Bytes;
+    return true;
+}
+
+string XlsxSheetReader::GetSheetPartName(const string& InSheetName) const
+{
+    for (size_t Num = 0; Num < SheetNames.size(); Num++)
+    {
+        if (SheetNames[Num] == InSheetName)
+        {
+            return SheetParts[Num];
+        }
+    }
+
+    return string();
+}
+
+bool XlsxSheetReader::ReadDimension(const string& InSheetName, XlsxSheetDimension& OutDimension) const
+{
+    const string SheetPart = GetSheetPartName(InSheetName);
+
+    XlsxArchive::EntryStream Stream;
+    if (SheetPart.empty() || Archive.OpenEntry(SheetPart, Stream) == false)
+    {
+        return false;
+    }
+
+    // <dimension> precedes <sheetData>, so only the first inflated chunk is parsed in practice
+    XmlPullParser Parser(Stream);
+    for (EEvent Event = Parser.Next(); Event == EEvent::StartElement || Event == EEvent::EndElement || Event == EEvent::Text; Event = Parser.Next())
+    {
+        if (Event != EEvent::StartElement)
+        {
+            continue;
+        }
+
+        const string_view LocalName = Parser.GetLocalName();
+        if (LocalName == "sheetData")
+        {
+            return false;
+        }
+
+        string_view Reference;
+        if (LocalName != "dimension" || Parser.FindAttribute("ref", Reference) == false)
+        {
+            continue;
+        }
+
+        // "A1:C10" -> C10, a single cell sheet is written as "A1"
+        const size_t Colon = Reference.find(':');
+        const string_view LastCell = Colon == string_view::npos ? Reference : Reference.substr(Colon + 1);
+        const size_t DigitsBegin = LastCell.find_first_of("0123456789");
+
+        OutDimension.Reference.assign(Reference);
+        OutDimension.LastColumn = ColumnFromReference(LastCell);
+        OutDimension.LastRow = DigitsBegin == string_view::npos ? 0 : ParseUnsigned(LastCell.substr(DigitsBegin));
+        return true;
+    }
+
+    return false;
+}
+
+bool XlsxSheetReader::ReadRows(const string& InSheetName, const RowCallback& InCallback, string* OutError) const
+{
+    auto Fail = [OutError](string InMessage)
+    {
+        if (OutError != nullptr)
+        {
+            *OutError = move(InMessage);
+        }
+        return false;
+    };
+
+    const string SheetPart = GetSheetPartName(InSheetName);
+    if (SheetPart.empty())
+    {
+        return Fail("Sheet not found : " + InSheetName);
+    }
+
+    string Error;
+    if (LoadSharedStrings(Error) == false)
+    {
+        return Fail(Error);
+    }
+
+    XlsxArchive::EntryStream Stream;
+    if (Archive.OpenEntry(SheetPart, Stream) == false)
+    {
+        return Fail("Failed to open " + SheetPart);
+    }
+
+    XlsxRow Row;
+    uint32_t LastRowNumber = 0;
+    bool bInRow = false;
+
+    // Cell being parsed
+    uint32_t CellColumn = 0;
+    string_view CellTypeAttr;
+    string CellType;
+    string CellText;
+    bool bInValue = false;
+    bool bInInline = false;
+    bool bInInlineText = false;
+    int PhoneticDepth = 0;
+
+    // Text of inline and formula string cells, kept per row so data rows reuse the allocation
+    string RowText;
+    vector<pair<size_t, pair<size_t, size_t>>> RowTextCells;
+
+    auto EmitRow = [&]() -> bool
+    {
+        for (const auto& TextCell : RowTextCells)
+        {
+            Row.Cells[TextCell.first].Text = string_view(RowText).substr(TextCell.second.first, TextCell.second.second);
+        }
+        return InCallback(Row);
+    };
+
+    XmlPullParser Parser(Stream);
+    for (EEvent Event = Parser.Next(); Event != EEvent::EndOfDocument; Event = Parser.Next())
+    {
+        if (Event == EEvent::Error)
+        {
+            return Fail("Malformed or corrupted " + SheetPart);
+        }
+
+        if (Event == EEvent::Text)
+        {
+            if (bInValue || bInInlineText)
+            {
+                if (Parser.IsCData())
+                {
+                    CellText.append(Parser.GetText());
+                }
+                else
+                {
+                    XmlPullParser::AppendDecoded(Parser.GetText(), CellText);
+                }
+            }
+            continue;
+        }
+
+        const string_view Name = Parser.GetLocalName();
+
+        if (Event == EEvent::StartElement)
+        {
+            if (Name == "row")
+            {
+                string_view Reference;
+                const uint32_t RowNumber = Parser.FindAttribute("r", Reference) ? ParseUnsigned(Reference) : LastRowNumber + 1;
+
+                // XLWorksheet::rows() visits every row number, so gaps are reported as empty rows
+                Row.Cells.clear();
+                RowTextCells.clear();
+                while (LastRowNumber + 1 < RowNumber)
+                {
+                    Row.RowNumber = ++LastRowNumber;
+                    if (InCallback(Row) == false)
+                    {
+                        return true;
+                    }
+                }
+
+                Row.RowNumber = RowNumber;
+                LastRowNumber = RowNumber;
+                RowText.clear();
+                bInRow = true;
+            }
+            else if (bInRow && Name == "c")
+            {
+                string_view Reference;
+                CellColumn = Parser.FindAttribute("r", Reference) ? ColumnFromReference(Reference) : static_cast<uint32_t>(Row.Cells.size()) + 1;
+
+                CellType.clear();
+                if (Parser.FindAttribute("t", CellTypeAttr))
+                {
+                    CellType.assign(CellTypeAttr);
+                }
+                CellText.clear();
+                bInValue = false;
+                bInInline = false;
+                bInInlineText = false;
+                PhoneticDepth = 0;
+            }
+            else if (bInRow && Name == "v")
+            {
+                bInValue = true;
+            }
+            else if (bInRow && Name == "is")
+            {
+                bInInline = true;
+            }
+            else if (bInInline && Name == "rPh")
+            {
+                PhoneticDepth++;
+            }
+            else if (bInInline && Name == "t")
+            {
+                bInInlineText = PhoneticDepth == 0;
+            }
+            continue;
+        }
+
+        // EndElement
+        if (Name == "v")
+        {
+            bInValue = false;
+        }
+        else if (Name == "t")
+        {
+            bInInlineText = false;
+        }
+        else if (Name == "rPh")
+        {
+            PhoneticDepth--;
+        }
+        else if (Name == "is")
+        {
+            bInInline = false;
+        }
+        else if (bInRow && Name == "c")
+        {
+            if (CellColumn == 0)
+            {
+                continue;
+            }
+
+            if (Row.Cells.size() < CellColumn)
+            {
+                Row.Cells.resize(CellColumn);
+            }
+
+            XlsxCell& Cell = Row.Cells[CellColumn - 1];
+            Cell = XlsxCell();
+
+            if (CellType == "s")
+            {
+                const uint32_t Index = ParseUnsigned(CellText);
+                if (CellText.empty())
+                {
+                    Cell.Type = EXlsxCellType::Empty;
+                }
+                else if (Index >= SharedStrings.size())
+                {
+                    return Fail("Shared string index out of range in " + SheetPart);
+                }
+                else
+                {
+                    Cell.Type = EXlsxCellType::String;
+                    Cell.Text = SharedStrings[Index];
+                }
+            }
+            else if (CellType == "str" || CellType == "inlineStr" || CellType == "d")
+            {
+                Cell.Type = EXlsxCellType::String;
+                RowTextCells.push_back(make_pair(static_cast<size_t>(CellColumn - 1), make_pair(RowText.size(), CellText.size())));
+                RowText.append(CellText);
+            }
+            else if (CellType == "b")
+            {
+                Cell.Type = CellText.empty() ? EXlsxCellType::Empty : EXlsxCellType::Boolean;
+                Cell.BoolValue = CellText == "1" || CellText == "true";
+            }
+            else if (CellType == "e")
+            {
+                Cell.Type = EXlsxCellType::Error;
+            }
+            else
+            {
+                AssignNumber(CellText, Cell);
+            }
+        }
+        else if (bInRow && Name == "row")
+        {
+            bInRow = false;
+            if (EmitRow() == false)
+            {
+                return true;
+            }
+        }
+    }
+
+    if (Stream.HasError())
+    {
+        return Fail("Corrupted zip entry " + SheetPart);
+    }
+
+    return true;
+}
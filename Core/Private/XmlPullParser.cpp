@@ -0,0 +1,436 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "XmlPullParser.h"
+
+#include <cstdlib>
+
+using namespace std;
+
+namespace
+{
+    constexpr size_t ReadChunkSize = 64 * 1024;
+
+    bool IsXmlSpace(char InChar)
+    {
+        return InChar == ' ' || InChar == '\t' || InChar == '\r' || InChar == '\n';
+    }
+
+    string_view StripPrefix(string_view InName)
+    {
+        const size_t Colon = InName.find(':');
+        return Colon == string_view::npos ? InName : InName.substr(Colon + 1);
+    }
+
+    void AppendUtf8(uint32_t InCodePoint, string& OutString)
+    {
+        if (InCodePoint < 0x80)
+        {
+            OutString.push_back(static_cast<char>(InCodePoint));
+        }
+        else if (InCodePoint < 0x800)
+        {
+            OutString.push_back(static_cast<char>(0xC0 | (InCodePoint >> 6)));
+            OutString.push_back(static_cast<char>(0x80 | (InCodePoint & 0x3F)));
+        }
+        else if (InCodePoint < 0x10000)
+        {
+            OutString.push_back(static_cast<char>(0xE0 | (InCodePoint >> 12)));
+            OutString.push_back(static_cast<char>(0x80 | ((InCodePoint >> 6) & 0x3F)));
+            OutString.push_back(static_cast<char>(0x80 | (InCodePoint & 0x3F)));
+        }
+        else
+        {
+            OutString.push_back(static_cast<char>(0xF0 | (InCodePoint >> 18)));
+            OutString.push_back(static_cast<char>(0x80 | ((InCodePoint >> 12) & 0x3F)));
+            OutString.push_back(static_cast<char>(0x80 | ((InCodePoint >> 6) & 0x3F)));
+            OutString.push_back(static_cast<char>(0x80 | (InCodePoint & 0x3F)));
+        }
+    }
+}
+
+XmlPullParser::XmlPullParser(XlsxArchive::EntryStream& InStream)
+    : Stream(&InStream)
+{
+}
+
+XmlPullParser::XmlPullParser(string_view InDocument)
+    : bStreamDone(true), Buffer(InDocument)
+{
+}
+
+bool XmlPullParser::Fill()
+{
+    if (Stream == nullptr || bStreamDone)
+    {
+        return false;
+    }
+
+    // Drop what has been consumed so the buffer only ever holds the unread tail and one chunk
+    if (Pos > 0)
+    {
+        Buffer.erase(0, Pos);
+        Pos = 0;
+    }
+
+    const size_t OldSize = Buffer.size();
+    Buffer.resize(OldSize + ReadChunkSize);
+    const size_t Read = Stream->Read(&Buffer[OldSize], ReadChunkSize);
+    Buffer.resize(OldSize + Read);
+
+    if (Read == 0)
+    {
+        bStreamDone = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool XmlPullParser::EnsureAhead(size_t InCount)
+{
+    while (Buffer.size() - Pos < InCount)
+    {
+        if (Fill() == false)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+size_t XmlPullParser::FindAhead(string_view InPattern, size_t InFromOffset)
+{
+    for (;;)
+    {
+        const size_t Found = string_view(Buffer).find(InPattern, Pos + InFromOffset);
+        if (Found != string_view::npos)
+        {
+            return Found - Pos;
+        }
+
+        // Resume where the pattern could still start after more data arrives
+        const size_t Scanned = Buffer.size() - Pos;
+        InFromOffset = Scanned >= InPattern.size() ? Scanned - InPattern.size() + 1 : 0;
+
+        if (Fill() == false)
+        {
+            return string::npos;
+        }
+    }
+}
+
+size_t XmlPullParser::FindTagEnd(size_t InFromOffset)
+{
+    char Quote = 0;
+    size_t Offset = InFromOffset;
+
+    for (;;)
+    {
+        for (; Pos + Offset < Buffer.size(); Offset++)
+        {
+            const char Char = Buffer[Pos + Offset];
+            if (Quote != 0)
+            {
+                if (Char == Quote)
+                {
+                    Quote = 0;
+                }
+            }
+            else if (Char == '"' || Char == '\'')
+            {
+                Quote = Char;
+            }
+            else if (Char == '>')
+            {
+                return Offset;
+            }
+        }
+
+        if (Fill() == false)
+        {
+            return string::npos;
+        }
+    }
+}
+
+void XmlPullParser::SetElement(size_t InNameBegin, size_t InNameEnd, size_t InAttrEnd)
+{
+    const string_view View(Buffer);
+    LocalName = StripPrefix(View.substr(Pos + InNameBegin, InNameEnd - InNameBegin));
+    Attributes = View.substr(Pos + InNameEnd, InAttrEnd - InNameEnd);
+}
+
+XmlPullParser::EEvent XmlPullParser::Next()
+{
+    if (bPendingEnd)
+    {
+        bPendingEnd = false;
+        bEmptyElement = false;
+        return EEvent::EndElement;
+    }
+
+    bCData = false;
+    bEmptyElement = false;
+
+    for (;;)
+    {
+        if (Pos >= Buffer.size() && Fill() == false)
+        {
+            return (Stream != nullptr && Stream->HasError()) ? EEvent::Error : EEvent::EndOfDocument;
+        }
+
+        if (Buffer[Pos] != '<')
+        {
+            const size_t TextEnd = FindAhead("<", 0);
+            const size_t TextLength = TextEnd == string::npos ? Buffer.size() - Pos : TextEnd;
+
+            Text = string_view(Buffer).substr(Pos, TextLength);
+            Pos += TextLength;
+            return EEvent::Text;
+        }
+
+        if (EnsureAhead(2) == false)
+        {
+            return EEvent::Error;
+        }
+
+        const char Kind = Buffer[Pos + 1];
+
+        if (Kind == '?')
+        {
+            const size_t End = FindAhead("?>", 2);
+            if (End == string::npos)
+            {
+                return EEvent::Error;
+            }
+            Pos += End + 2;
+            continue;
+        }
+
+        if (Kind == '!')
+        {
+            if (EnsureAhead(4) && Buffer.compare(Pos, 4, "<!--") == 0)
+            {
+                const size_t End = FindAhead("-->", 4);
+                if (End == string::npos)
+                {
+                    return EEvent::Error;
+                }
+                Pos += End + 3;
+                continue;
+            }
+
+            if (EnsureAhead(9) && Buffer.compare(Pos, 9, "<![CDATA[") == 0)
+            {
+                const size_t End = FindAhead("]]>", 9);
+                if (End == string::npos)
+                {
+                    return EEvent::Error;
+                }
+                Text = string_view(Buffer).substr(Pos + 9, End - 9);
+                bCData = true;
+                Pos += End + 3;
+                return EEvent::Text;
+            }
+
+            const size_t End = FindTagEnd(2);
+            if (End == string::npos)
+            {
+                return EEvent::Error;
+            }
+            Pos += End + 1;
+            continue;
+        }
+
+        const bool bEndTag = Kind == '/';
+        const size_t TagEnd = FindTagEnd(bEndTag ? 2 : 1);
+        if (TagEnd == string::npos)
+        {
+            return EEvent::Error;
+        }
+
+        const size_t NameBegin = bEndTag ? 2 : 1;
+        size_t NameEnd = NameBegin;
+        while (NameEnd < TagEnd && IsXmlSpace(Buffer[Pos + NameEnd]) == false && Buffer[Pos + NameEnd] != '/')
+        {
+            NameEnd++;
+        }
+
+        size_t AttrEnd = TagEnd;
+        if (bEndTag == false && Buffer[Pos + TagEnd - 1] == '/')
+        {
+            bEmptyElement = true;
+            AttrEnd = TagEnd - 1;
+        }
+
+        SetElement(NameBegin, NameEnd, AttrEnd);
+        Pos += TagEnd + 1;
+
+        if (bEndTag)
+        {
+            return EEvent::EndElement;
+        }
+
+        bPendingEnd = bEmptyElement;
+        return EEvent::StartElement;
+    }
+}
+
+bool XmlPullParser::FindAttribute(string_view InLocalName, string_view& OutValue) const
+{
+    size_t Offset = 0;
+    const size_t Length = Attributes.size();
+
+    while (Offset < Length)
+    {
+        while (Offset < Length && IsXmlSpace(Attributes[Offset]))
+        {
+            Offset++;
+        }
+
+        const size_t NameBegin = Offset;
+        while (Offset < Length && Attributes[Offset] != '=' && IsXmlSpace(Attributes[Offset]) == false)
+        {
+            Offset++;
+        }
+        const string_view Name = Attributes.substr(NameBegin, Offset - NameBegin);
+
+        while (Offset < Length && (IsXmlSpace(Attributes[Offset]) || Attributes[Offset] == '='))
+        {
+            Offset++;
+        }
+
+        if (Offset >= Length || (Attributes[Offset] != '"' && Attributes[Offset] != '\''))
+        {
+            return false;
+        }
+
+        const char Quote = Attributes[Offset++];
+        const size_t ValueEnd = Attributes.find(Quote, Offset);
+        if (ValueEnd == string_view::npos)
+        {
+            return false;
+        }
+
+        const bool bNamespaceDecl = Name == "xmlns" || Name.substr(0, 6) == "xmlns:";
+        if (bNamespaceDecl == false && StripPrefix(Name) == InLocalName)
+        {
+            OutValue = Attributes.substr(Offset, ValueEnd - Offset);
+            return true;
+        }
+
+        Offset = ValueEnd + 1;
+    }
+
+    return false;
+}
+
+void XmlPullParser::AppendDecoded(string_view InRaw, string& OutDecoded)
+{
+    size_t Offset = 0;
+
+    while (Offset < InRaw.size())
+    {
+        const size_t Special = InRaw.find_first_of("&\r", Offset);
+        if (Special == string_view::npos)
+        {
+            OutDecoded.append(InRaw.data() + Offset, InRaw.size() - Offset);
+            return;
+        }
+
+        OutDecoded.append(InRaw.data() + Offset, Special - Offset);
+        Offset = Special;
+
+        if (InRaw[Offset] == '\r')
+        {
+            OutDecoded.push_back('\n');
+            Offset += (Offset + 1 < InRaw.size() && InRaw[Offset + 1] == '\n') ? 2 : 1;
+            continue;
+        }
+
+        const size_t Semicolon = InRaw.find(';', Offset);
+        if (Semicolon == string_view::npos)
+        {
+            OutDecoded.push_back('&');
+            Offset++;
+            continue;
+        }
+
+        const string_view Entity = InRaw.substr(Offset + 1, Semicolon - Offset - 1);
+
+        if (Entity == "lt")
+        {
+            OutDecoded.push_back('<');
+        }
+        else if (Entity == "gt")
+        {
+            OutDecoded.push_back('>');
+        }
+        else if (Entity == "amp")
+        {
+            OutDecoded.push_back('&');
+        }
+        else if (Entity == "quot")
+        {
+            OutDecoded.push_back('"');
+        }
+        else if (Entity == "apos")
+        {
+            OutDecoded.push_back('\'');
+        }
+        else if (Entity.size() > 1 && Entity[0] == '#')
+        {
+            const bool bHex = Entity[1] == 'x' || Entity[1] == 'X';
+            const string_view Digits = Entity.substr(bHex ? 2 : 1);
+
+            uint32_t CodePoint = 0;
+            bool bValid = Digits.empty() == false;
+            for (const char Digit : Digits)
+            {
+                uint32_t Value = 0;
+                if (Digit >= '0' && Digit <= '9')
+                {
+                    Value = Digit - '0';
+                }
+                else if (bHex && Digit >= 'a' && Digit <= 'f')
+                {
+                    Value = Digit - 'a' + 10;
+                }
+                else if (bHex && Digit >= 'A' && Digit <= 'F')
+                {
+                    Value = Digit - 'A' + 10;
+                }
+                else
+                {
+                    bValid = false;
+                    break;
+                }
+                CodePoint = CodePoint * (bHex ? 16 : 10) + Value;
+                if (CodePoint > 0x10FFFF)
+                {
+                    bValid = false;
+                    break;
+                }
+            }
+
+            if (bValid == false)
+            {
+                OutDecoded.push_back('&');
+                Offset++;
+                continue;
+            }
+
+            AppendUtf8(CodePoint, OutDecoded);
+        }
+        else
+        {
+            // Unknown entity is kept verbatim, as pugixml does
+            OutDecoded.push_back('&');
+            Offset++;
+            continue;
+        }
+
+        Offset = Semicolon + 1;
+    }
+}
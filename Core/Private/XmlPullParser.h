@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "XlsxArchive.h"
+
+/**
+ * Forward-only XML tokenizer for the parts of an .xlsx package.
+ * Reads the source in fixed-size chunks and only keeps the unread tail plus the current token,
+ * so memory stays bounded by the largest single token instead of the document size.
+ * Views returned by the getters are valid until the next call to Next.
+ */
+class XmlPullParser
+{
+public:
+    enum class EEvent : unsigned char
+    {
+        StartElement,
+        EndElement,
+        Text,
+        EndOfDocument,
+        Error,
+    };
+
+    explicit XmlPullParser(XlsxArchive::EntryStream& InStream);
+    explicit XmlPullParser(std::string_view InDocument);
+
+    EEvent Next();
+
+    // Element name without namespace prefix
+    std::string_view GetLocalName() const { return LocalName; }
+    bool IsEmptyElement() const { return bEmptyElement; }
+
+    // Raw attribute value, still escaped. Matches on the local name and ignores namespace declarations.
+    bool FindAttribute(std::string_view InLocalName, std::string_view& OutValue) const;
+
+    // Raw text, still escaped unless IsCData
+    std::string_view GetText() const { return Text; }
+    bool IsCData() const { return bCData; }
+
+    // Appends InRaw to OutDecoded, resolving entities and normalizing line endings the way pugixml does
+    static void AppendDecoded(std::string_view InRaw, std::string& OutDecoded);
+
+private:
+    bool Fill();
+    bool EnsureAhead(size_t InCount);
+    size_t FindAhead(std::string_view InPattern, size_t InFromOffset);
+    size_t FindTagEnd(size_t InFromOffset);
+
+    void SetElement(size_t InNameBegin, size_t InNameEnd, size_t InAttrEnd);
+
+private:
+    XlsxArchive::EntryStream* Stream = nullptr;
+    bool bStreamDone = false;
+
+    std::string Buffer;
+    size_t Pos = 0;
+
+    std::string_view LocalName;
+    std::string_view Attributes;
+    std::string_view Text;
+
+    bool bEmptyElement = false;
+    bool bPendingEnd = false;
+    bool bCData = false;
+};
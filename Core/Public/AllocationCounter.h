@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Heap allocations counted by the host process, read before and after a piece of work to tell how many it made.
+ * The core does not replace the allocator : XlsxToCsv counts in its operator new, the editor benchmark in an FMalloc proxy.
+ */
+class AllocationCounter
+{
+public:
+    // Allocations made so far on the calling thread
+    using ReadFunc = uint64_t (*)();
+
+    // Null stops counting
+    static void SetSource(ReadFunc InRead);
+
+    static bool IsCounting();
+
+    // 0 while no source is set
+    static uint64_t Read();
+
+private:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    static std::atomic<ReadFunc> Source;
+};
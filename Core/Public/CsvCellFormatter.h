@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "XlsxSheetReader.h"
+
+/**
+ * Writes typed cell values as CSV text into a caller-owned buffer.
+ * Output is identical to streaming an XLCellValue into a std::ostream, without the stream and temporary strings.
+ */
+class CsvCellFormatter
+{
+public:
+    static void AppendValue(const XlsxCell& InCell, std::string& OutBuffer);
+
+    // Calls InFunc(std::string_view) for each '=' separated token the way getline(Ss, Parse, '=') splits
+    template<typename FuncType>
+    static void ForEachHeaderToken(std::string_view InText, FuncType&& InFunc)
+    {
+        size_t Begin = 0;
+        while (Begin < InText.size())
+        {
+            size_t End = InText.find('=', Begin);
+            if (End == std::string_view::npos)
+            {
+                End = InText.size();
+            }
+
+            InFunc(InText.substr(Begin, End - Begin));
+            Begin = End + 1;
+        }
+    }
+
+private:
+    CsvCellFormatter();
+    ~CsvCellFormatter();
+};
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Buffered UTF-8 writer for one CSV file.
+ * Text goes through a fixed-size buffer that is flushed to a temporary file next to the target, so memory
+ * use does not depend on the size of the sheet. Commit renames the temporary file over the target in one
+ * step; a writer destroyed or discarded before Commit leaves the previous CSV untouched.
+ */
+class CsvFileWriter
+{
+public:
+    static constexpr size_t DefaultBufferSize = 64 * 1024;
+
+    explicit CsvFileWriter(size_t InBufferSize = DefaultBufferSize);
+    ~CsvFileWriter();
+
+    CsvFileWriter(const CsvFileWriter&) = delete;
+    CsvFileWriter& operator=(const CsvFileWriter&) = delete;
+
+    bool Open(const std::filesystem::path& InFilePath);
+
+    // InText must already be UTF-8
+    void Append(std::string_view InText);
+    void Append(char InChar);
+
+    bool Commit();
+    void Discard();
+
+    bool HasError() const { return bError; }
+    const std::string& GetLastError() const { return LastError; }
+
+    // Size and zlib CRC32 of the flushed bytes, which is the whole file after Commit
+    uint64_t GetBytesWritten() const { return BytesWritten; }
+    uint32_t GetCrc32() const { return Crc; }
+
+private:
+    void Flush();
+    void Fail(std::string InMessage);
+
+private:
+    std::filesystem::path TargetPath;
+    std::filesystem::path TempPath;
+    std::ofstream File;
+
+    std::vector<char> Buffer;
+    size_t Used = 0;
+
+    uint64_t BytesWritten = 0;
+    uint32_t Crc = 0;
+
+    std::string LastError;
+    bool bError = false;
+};
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+struct DataTypeToken
+{
+    // Lower case spelling accepted in the type row of a sheet
+    std::string_view Token;
+
+    // Type written into the generated USTRUCT
+    std::string_view UnrealType;
+};
+
+// Case-insensitive hashing shared by the table layout and the lookup
+struct DataTypeTokenHash
+{
+    static constexpr char ToLower(char InChar)
+    {
+        return InChar >= 'A' && InChar <= 'Z' ? static_cast<char>(InChar - 'A' + 'a') : InChar;
+    }
+
+    // FNV-1a over the lower case bytes
+    static constexpr uint32_t Hash(std::string_view InText)
+    {
+        uint32_t Value = 2166136261u;
+        for (const char Char : InText)
+        {
+            Value = (Value ^ static_cast<uint8_t>(ToLower(Char))) * 16777619u;
+        }
+        return Value;
+    }
+
+    static constexpr bool EqualsIgnoreCase(std::string_view InLower, std::string_view InText)
+    {
+        if (InLower.size() != InText.size())
+        {
+            return false;
+        }
+
+        for (size_t Index = 0; Index < InText.size(); Index++)
+        {
+            if (InLower[Index] != ToLower(InText[Index]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Open addressing slots holding token indices, EmptySlot where unused
+    template<size_t SlotCount, size_t TokenCount>
+    static constexpr std::array<uint8_t, SlotCount> BuildSlots(const DataTypeToken (&InTokens)[TokenCount])
+    {
+        std::array<uint8_t, SlotCount> Result{};
+        for (uint8_t& Slot : Result)
+        {
+            Slot = EmptySlot;
+        }
+
+        for (size_t Index = 0; Index < TokenCount; Index++)
+        {
+            size_t Slot = Hash(InTokens[Index].Token) & (SlotCount - 1);
+            while (Result[Slot] != EmptySlot)
+            {
+                Slot = (Slot + 1) & (SlotCount - 1);
+            }
+            Result[Slot] = static_cast<uint8_t>(Index);
+        }
+
+        return Result;
+    }
+
+    static constexpr uint8_t EmptySlot = 0xFF;
+};
+
+inline constexpr DataTypeToken DataTypeTokens[] =
+{
+    { "int", "int32" },
+    { "uint", "uint32" },
+    { "int8", "int8" },
+    { "uint8", "uint8" },
+    { "int16", "int16" },
+    { "uint16", "uint16" },
+    { "int32", "int32" },
+    { "uint32", "uint32" },
+    { "int64", "int64" },
+    { "uint64", "uint64" },
+    { "float", "float" },
+    { "double", "double" },
+    { "long double", "double" },
+    { "bool", "bool" },
+    { "boolean", "bool" },
+    { "char", "char" },
+    { "ansichar", "ANSICHAR" },
+    { "tchar", "TCHAR" },
+    { "string", "FString" },
+    { "fstring", "FString" },
+    { "text", "FText" },
+    { "ftext", "FText" },
+    { "fname", "FName" },
+};
+
+/**
+ * The type words of a sheet's type row, shared by header detection in XlsxManager and by StructGenerator.
+ * Lookup is case-insensitive and allocation free : a hash table laid out at compile time, one probe in practice.
+ */
+class DataTypeTokenTable
+{
+public:
+    static constexpr size_t TokenCount = sizeof(DataTypeTokens) / sizeof(DataTypeTokens[0]);
+
+    // nullptr if InToken is not a type word
+    static constexpr const DataTypeToken* Find(std::string_view InToken)
+    {
+        for (size_t Slot = DataTypeTokenHash::Hash(InToken) & SlotMask; Slots[Slot] != DataTypeTokenHash::EmptySlot; Slot = (Slot + 1) & SlotMask)
+        {
+            const DataTypeToken& Candidate = DataTypeTokens[Slots[Slot]];
+            if (DataTypeTokenHash::EqualsIgnoreCase(Candidate.Token, InToken))
+            {
+                return &Candidate;
+            }
+        }
+
+        return nullptr;
+    }
+
+    static constexpr bool Contains(std::string_view InToken)
+    {
+        return Find(InToken) != nullptr;
+    }
+
+private:
+    static constexpr size_t SlotCount = 64;
+    static constexpr size_t SlotMask = SlotCount - 1;
+
+    static_assert(TokenCount * 2 <= SlotCount, "Keep the table at most half full so probes stay short");
+
+    static constexpr std::array<uint8_t, SlotCount> Slots = DataTypeTokenHash::BuildSlots<SlotCount>(DataTypeTokens);
+};
+
+static_assert(DataTypeTokenTable::Contains("FString") && DataTypeTokenTable::Contains("long double") && DataTypeTokenTable::Contains("KEY") == false, "DataTypeTokenTable lookup is broken");
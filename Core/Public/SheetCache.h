@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "SheetTableReader.h"
+
+#define SHEET_CACHE_EXTENSION ".dtcache"
+
+enum class ESheetCacheStorage : uint8_t
+{
+    // uint32 ids into the string dictionary
+    String,
+    Int,
+    Real,
+};
+
+// On-disk layout, little-endian. Every section starts on an 8 byte boundary and is addressed by file offset,
+// so a mapped file is read in place without any fix-ups.
+struct SheetCacheHeader
+{
+    char Magic[4];
+    uint32_t Version;
+    uint32_t ColumnCount;
+    uint32_t StringCount;
+    uint64_t RowCount;
+
+    // RowCount string ids
+    uint64_t KeysOffset;
+
+    // StringCount + 1 uint32 offsets into the string bytes, then the bytes themselves
+    uint64_t StringOffsetsOffset;
+    uint64_t StringBytesOffset;
+};
+
+struct SheetCacheColumn
+{
+    uint32_t NameId;
+    uint32_t TypeId;
+    ESheetCacheStorage Storage;
+    uint8_t Reserved[7];
+
+    // RowCount int64, double or string ids depending on Storage
+    uint64_t DataOffset;
+};
+
+static_assert(sizeof(SheetCacheHeader) == 48 && sizeof(SheetCacheColumn) == 24, "SheetCache layout must not depend on the compiler");
+
+/**
+ * Typed columnar copy of a sheet's table, written next to its CSV so later stages skip text parsing.
+ * Columns typed as integers or floating point are stored as int64 / double when every cell round-trips to the
+ * same text, anything else is stored as ids into one string dictionary shared with the key, names and types.
+ *
+ * Rows are added one at a time as SheetTableReader hands them out. Each column's values are kept for a block of
+ * rows and full blocks are spilled to a temporary file next to the target, so only the block and the string
+ * dictionary stay in memory. Commit lays the columns out and renames the cache into place like CsvFileWriter.
+ */
+class SheetCacheWriter
+{
+public:
+    static constexpr uint32_t Version = 1;
+    static constexpr size_t DefaultBlockRows = 4096;
+
+    explicit SheetCacheWriter(size_t InBlockRows = DefaultBlockRows);
+    ~SheetCacheWriter();
+
+    SheetCacheWriter(const SheetCacheWriter&) = delete;
+    SheetCacheWriter& operator=(const SheetCacheWriter&) = delete;
+
+    bool Open(const std::filesystem::path& InFilePath, std::string& OutError);
+
+    // The Types and Names rows define the columns and must come before the data rows
+    void AddRow(const SheetTableRow& InRow);
+
+    bool Commit(std::string& OutError);
+    void Discard();
+
+private:
+    struct ColumnState
+    {
+        SheetCacheColumn Desc;
+
+        // Storage the column type asked for, kept after a cell demotes the column to String
+        ESheetCacheStorage TypedStorage = ESheetCacheStorage::String;
+
+        // Rows of a String column before this one still hold TypedStorage values, 0 unless the column was demoted
+        uint64_t DemotedAtRow = 0;
+    };
+
+    void BeginColumns();
+    uint32_t Intern(std::string_view InText);
+    void SpillBlock();
+
+    // InCount slots of InColumn from block InBlock, spilled or not
+    const uint64_t* ReadColumnSlots(size_t InBlock, size_t InColumn, size_t InCount);
+    const uint32_t* ReadKeys(size_t InBlock, size_t InCount);
+
+    // The CSV text of a numeric slot, the same text it was parsed from
+    static std::string_view FormatSlot(ESheetCacheStorage InStorage, uint64_t InSlot, char (&OutDigits)[32]);
+
+    void Fail(std::string InMessage);
+
+private:
+    std::filesystem::path TargetPath;
+    std::filesystem::path SpillPath;
+    std::fstream SpillFile;
+
+    size_t BlockRows = 0;
+    size_t SpilledBlocks = 0;
+    uint64_t RowCount = 0;
+
+    std::vector<std::string> Types;
+    std::vector<std::string> Names;
+    std::vector<ColumnState> Columns;
+    bool bColumnsReady = false;
+
+    // Column-major block of int64 / double bits or string ids, then the block's key ids
+    std::vector<uint64_t> BlockSlots;
+    std::vector<uint32_t> BlockKeys;
+    size_t BlockUsed = 0;
+
+    // Buffers a spilled block slice is read back into
+    std::vector<uint64_t> ReadSlots;
+    std::vector<uint32_t> ReadKeyIds;
+
+    // Every distinct string once, the map's views point into the deque which never moves its elements
+    std::deque<std::string> Strings;
+    std::unordered_map<std::string_view, uint32_t> StringIds;
+    uint64_t StringBytes = 0;
+
+    std::string LastError;
+    bool bError = false;
+};
+
+/**
+ * Read-only view of a sheet cache. Open maps the file where the platform allows it and reads it in one go
+ * otherwise; all string views point into that memory and stay valid until Close.
+ */
+class SheetCache
+{
+public:
+    SheetCache();
+    ~SheetCache();
+
+    SheetCache(const SheetCache&) = delete;
+    SheetCache& operator=(const SheetCache&) = delete;
+
+    bool Open(const std::filesystem::path& InFilePath, std::string& OutError);
+
+    // InData must outlive the cache
+    bool OpenView(const void* InData, size_t InSize, std::string& OutError);
+
+    void Close();
+
+    bool IsOpen() const { return Header != nullptr; }
+
+    size_t GetRowCount() const { return static_cast<size_t>(Header->RowCount); }
+    size_t GetColumnCount() const { return Header->ColumnCount; }
+
+    std::string_view GetColumnName(size_t InColumn) const { return GetDictionaryString(Columns[InColumn].NameId); }
+    std::string_view GetColumnType(size_t InColumn) const { return GetDictionaryString(Columns[InColumn].TypeId); }
+    ESheetCacheStorage GetColumnStorage(size_t InColumn) const { return Columns[InColumn].Storage; }
+
+    std::string_view GetKey(size_t InRow) const { return GetDictionaryString(Keys[InRow]); }
+
+    // Each getter is only valid for columns with the matching storage
+    int64_t GetInt(size_t InRow, size_t InColumn) const { return reinterpret_cast<const int64_t*>(Data + Columns[InColumn].DataOffset)[InRow]; }
+    double GetReal(size_t InRow, size_t InColumn) const { return reinterpret_cast<const double*>(Data + Columns[InColumn].DataOffset)[InRow]; }
+    std::string_view GetString(size_t InRow, size_t InColumn) const { return GetDictionaryString(reinterpret_cast<const uint32_t*>(Data + Columns[InColumn].DataOffset)[InRow]); }
+
+    // The cell as it appears in the CSV, whatever the storage
+    void AppendText(size_t InRow, size_t InColumn, std::string& OutText) const;
+
+private:
+    bool Validate(std::string& OutError);
+
+    std::string_view GetDictionaryString(uint32_t InId) const
+    {
+        if (InId >= Header->StringCount)
+        {
+            return std::string_view();
+        }
+        return std::string_view(StringBytes + StringOffsets[InId], StringOffsets[InId + 1] - StringOffsets[InId]);
+    }
+
+private:
+    const uint8_t* Data = nullptr;
+    size_t Size = 0;
+
+    // Whichever of the two holds the file when it was opened by path
+    void* Mapping = nullptr;
+    std::vector<uint8_t> Loaded;
+
+    const SheetCacheHeader* Header = nullptr;
+    const SheetCacheColumn* Columns = nullptr;
+    const uint32_t* Keys = nullptr;
+    const uint32_t* StringOffsets = nullptr;
+    const char* StringBytes = nullptr;
+};
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "XlsxSheetReader.h"
+#include "SheetTableReader.h"
+
+struct SheetCsvStats
+{
+    int32_t Rows = 0;
+    int32_t DataRows = 0;
+
+    // Heap allocations made on the data rows, 0 when no AllocationCounter source is installed
+    uint64_t DataRowAllocations = 0;
+
+    // UTF-8 bytes written to the CSV and their zlib CRC32
+    uint64_t OutputBytes = 0;
+    uint32_t OutputCrc = 0;
+
+    // Set when a sheet cache was requested : written, or why not. The CSV is kept either way.
+    bool bSheetCacheWritten = false;
+    std::string SheetCacheError;
+
+    // Header rows of the converted table, so struct generation does not read them back from the CSV
+    SheetSchema Schema;
+};
+
+/**
+ * Sheet -> CSV conversion without engine types, shared by XlsxManager and the standalone DataTableCore build.
+ * Rows come from SheetTableReader and are written as "<Key>,<cells>" lines.
+ */
+class SheetCsvConverter
+{
+public:
+    // Writes InSheetName to OutCsvFilePath through CsvFileWriter, the previous file is kept on failure or cancel.
+    // InCancelFlag is checked between rows; a cancelled sheet fails with "Cancelled".
+    // A non-empty OutSheetCachePath also streams the table there as a SheetCache, committed right after the CSV.
+    // Only the CSV decides the result; a cache that fails is removed and reported in OutStats.
+    static bool Convert(const XlsxSheetReader& InReader, const std::string& InSheetName, const std::filesystem::path& OutCsvFilePath,
+        SheetCsvStats& OutStats, std::string& OutError, const std::atomic<bool>* InCancelFlag = nullptr,
+        const std::filesystem::path& OutSheetCachePath = std::filesystem::path());
+
+    // Reads only the two header lines of a CSV written by Convert, however many rows follow them.
+    // The KEY column is not recorded in the CSV, so OutSchema.KeyColumn stays -1.
+    static bool ReadSchema(const std::filesystem::path& InCsvFilePath, SheetSchema& OutSchema, std::string& OutError);
+
+    // Case-insensitive, see DataTypeTokenTable
+    static bool IsDataTypeToken(std::string_view InToken);
+
+private:
+    SheetCsvConverter();
+    ~SheetCsvConverter();
+};
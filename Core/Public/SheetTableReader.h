@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "XlsxSheetReader.h"
+
+enum class ESheetRowKind : uint8_t
+{
+    // Type tokens, the text left of '=' in each header cell
+    Types,
+    Names,
+    Data,
+};
+
+// One row of the table part of a sheet, valid only during the callback
+struct SheetTableRow
+{
+    ESheetRowKind Kind = ESheetRowKind::Data;
+
+    // "Key" on the two header rows, the KEY cell or the row number on data rows
+    std::string_view Key;
+
+    // Cells from the first typed column on, joined with ',' : exactly the CSV text after the key
+    std::string_view Text;
+
+    // Offset of each cell in Text
+    const std::vector<size_t>* CellBegins = nullptr;
+
+    // Index of the KEY cell among the row's cells, -1 when data rows are numbered
+    int32_t KeyColumn = -1;
+
+    size_t GetCellCount() const { return CellBegins->size(); }
+
+    std::string_view GetCell(size_t InIndex) const
+    {
+        const size_t Begin = (*CellBegins)[InIndex];
+        const size_t End = InIndex + 1 < CellBegins->size() ? (*CellBegins)[InIndex + 1] - 1 : Text.size();
+        return Text.substr(Begin, End - Begin);
+    }
+};
+
+// The two header rows of a sheet's table, all a row struct is generated from
+struct SheetSchema
+{
+    std::vector<std::string> Types;
+    std::vector<std::string> Names;
+
+    // Index in Types / Names of the column typed "<type>=KEY", -1 when data rows are numbered or it is not known
+    int32_t KeyColumn = -1;
+
+    bool IsValid() const { return Names.empty() == false && Names.size() == Types.size(); }
+
+    // Takes the header rows, data rows are ignored
+    void AddRow(const SheetTableRow& InRow);
+};
+
+struct SheetTableStats
+{
+    // Every row of the sheet, including the ones above the header
+    int32_t Rows = 0;
+    int32_t DataRows = 0;
+
+    // Heap allocations made while parsing, formatting and handing on the data rows, as counted by AllocationCounter.
+    // 0 when no counter is installed.
+    uint64_t DataRowAllocations = 0;
+};
+
+/**
+ * A sheet's table held in memory : the header rows plus every data row's key and cells, back to back in one buffer.
+ * About one byte per byte of cell text and four per cell, so it is much smaller than the CSV text it replaces.
+ */
+struct SheetTable
+{
+    std::vector<std::string> Types;
+    std::vector<std::string> Names;
+
+    size_t GetRowCount() const { return RowFirstCell.empty() ? 0 : RowFirstCell.size() - 1; }
+
+    std::string_view GetKey(size_t InRow) const { return GetText(RowFirstCell[InRow]); }
+    size_t GetCellCount(size_t InRow) const { return RowFirstCell[InRow + 1] - RowFirstCell[InRow] - 1; }
+    std::string_view GetCell(size_t InRow, size_t InColumn) const { return GetText(RowFirstCell[InRow] + 1 + InColumn); }
+
+    void Reset();
+    void AddRow(const SheetTableRow& InRow);
+    // Drops the spare capacity left by growing while rows were added
+    void ShrinkToFit();
+    size_t GetMemoryFootprint() const;
+
+private:
+    std::string_view GetText(size_t InCell) const
+    {
+        const uint32_t Begin = InCell == 0 ? 0 : CellEnds[InCell - 1];
+        return std::string_view(Text).substr(Begin, CellEnds[InCell] - Begin);
+    }
+
+    // Key then cells of every data row, without separators
+    std::string Text;
+    std::vector<uint32_t> CellEnds;
+
+    // Index in CellEnds of each row's key, plus one past the last row
+    std::vector<uint32_t> RowFirstCell;
+};
+
+/**
+ * Finds the table in a sheet and hands it out row by row, the part of the sheet -> CSV conversion that does not
+ * depend on the output. The header row is the first row holding a type token (see DataTypeTokenTable); cells left
+ * of the first one are dropped. A column typed "<type>=KEY" becomes the key, otherwise data rows are numbered.
+ */
+class SheetTableReader
+{
+public:
+    // Return false to stop reading
+    using RowCallback = std::function<bool(const SheetTableRow&)>;
+
+    // InCancelFlag is checked between rows; a cancelled read fails with "Cancelled"
+    static bool ReadRows(const XlsxSheetReader& InReader, const std::string& InSheetName, const RowCallback& InCallback,
+        SheetTableStats& OutStats, std::string& OutError, const std::atomic<bool>* InCancelFlag = nullptr);
+
+    // The whole table in memory, for importers that need every row at once
+    static bool Load(const XlsxSheetReader& InReader, const std::string& InSheetName, SheetTable& OutTable,
+        SheetTableStats& OutStats, std::string& OutError, const std::atomic<bool>* InCancelFlag = nullptr);
+
+private:
+    SheetTableReader();
+    ~SheetTableReader();
+};
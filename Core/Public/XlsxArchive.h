@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Read-only view of the zip container of an .xlsx file.
+ * Only the central directory is kept in memory; entries are inflated on demand in fixed-size chunks,
+ * so reading a sheet never needs the whole decompressed part at once.
+ * The directory is immutable after Open, so several EntryStreams may read from one archive concurrently.
+ */
+class XlsxArchive
+{
+public:
+    struct Entry
+    {
+        std::string Name;
+        uint16_t Method = 0;
+        uint32_t Crc32 = 0;
+        uint64_t CompressedSize = 0;
+        uint64_t UncompressedSize = 0;
+        uint64_t LocalHeaderOffset = 0;
+    };
+
+    class EntryStream
+    {
+    public:
+        EntryStream();
+        ~EntryStream();
+
+        EntryStream(const EntryStream&) = delete;
+        EntryStream& operator=(const EntryStream&) = delete;
+
+        bool Open(const std::filesystem::path& InArchivePath, const Entry& InEntry);
+
+        // Returns the number of bytes written to OutBuffer, 0 at the end of the entry or on error.
+        size_t Read(char* OutBuffer, size_t InSize);
+
+        bool HasError() const { return bError; }
+        bool IsFinished() const { return bFinished; }
+
+    private:
+        bool FillInput();
+
+    private:
+        std::ifstream File;
+        Entry Source;
+
+        struct InflateState;
+        std::unique_ptr<InflateState> Inflater;
+
+        std::vector<char> InputBuffer;
+        uint64_t RemainingInput = 0;
+        uint64_t Produced = 0;
+        uint32_t RunningCrc = 0;
+
+        bool bFinished = false;
+        bool bError = false;
+    };
+
+public:
+    bool Open(const std::filesystem::path& InArchivePath);
+    void Close();
+
+    bool IsOpen() const { return bOpened; }
+    const std::filesystem::path& GetPath() const { return ArchivePath; }
+    const std::string& GetLastError() const { return LastError; }
+
+    const Entry* FindEntry(const std::string& InName) const;
+    const std::vector<Entry>& GetEntries() const { return Entries; }
+
+    bool OpenEntry(const std::string& InName, EntryStream& OutStream) const;
+    bool ReadEntry(const std::string& InName, std::string& OutData) const;
+
+private:
+    bool ReadCentralDirectory(std::ifstream& InFile);
+
+private:
+    std::filesystem::path ArchivePath;
+    std::vector<Entry> Entries;
+    std::unordered_map<std::string, size_t> EntryIndex;
+
+    std::string LastError;
+    bool bOpened = false;
+};
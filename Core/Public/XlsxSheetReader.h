@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "XlsxArchive.h"
+
+enum class EXlsxCellType : uint8_t
+{
+    Empty,
+    Boolean,
+    Integer,
+    Float,
+    String,
+    Error,
+};
+
+struct XlsxCell
+{
+    EXlsxCellType Type = EXlsxCellType::Empty;
+    bool BoolValue = false;
+    int64_t IntValue = 0;
+    double FloatValue = 0.0;
+
+    // String cells only. Points into the shared string table or the row's own storage.
+    std::string_view Text;
+};
+
+struct XlsxRow
+{
+    // 1-based, like the row numbers shown in Excel
+    uint32_t RowNumber = 0;
+
+    // Dense from column A up to the last cell of the row, missing cells are Empty
+    std::vector<XlsxCell> Cells;
+};
+
+struct XlsxSheetDimension
+{
+    // Reference as written in the sheet, e.g. "A1:C10"
+    std::string Reference;
+
+    // 1-based bottom right corner of the used range
+    uint32_t LastRow = 0;
+    uint32_t LastColumn = 0;
+};
+
+/**
+ * Streaming reader for the worksheets of an .xlsx file.
+ * Sheet XML is parsed forward-only and delivered one row at a time, so memory use depends on the width
+ * of a row and the shared string table, not on the number of rows.
+ * Rows are delivered the same way XLWorksheet::rows() enumerates them : from row 1 up to the last row,
+ * with rows missing from the XML reported as rows without cells.
+ */
+class XlsxSheetReader
+{
+public:
+    // Return false to stop reading. The row and its string views are only valid during the call.
+    using RowCallback = std::function<bool(const XlsxRow&)>;
+
+    XlsxSheetReader();
+    ~XlsxSheetReader();
+
+    bool Open(const std::filesystem::path& InXlsxFilePath);
+    void Close();
+
+    bool IsOpen() const { return Archive.IsOpen(); }
+    const std::string& GetLastError() const { return LastError; }
+
+    const XlsxArchive& GetArchive() const { return Archive; }
+    const std::vector<std::string>& GetSheetNames() const { return SheetNames; }
+
+    // Package part holding the shared string table, empty if the workbook has none
+    const std::string& GetSharedStringsPartName() const { return SharedStringsPart; }
+
+    // Package part holding the sheet XML (e.g. "xl/worksheets/sheet1.xml"), empty if there is no such sheet
+    std::string GetSheetPartName(const std::string& InSheetName) const;
+
+    // Reads only the head of the sheet XML up to <sheetData>. False when the sheet has no <dimension> element.
+    bool ReadDimension(const std::string& InSheetName, XlsxSheetDimension& OutDimension) const;
+
+    // Approximate heap bytes held by the reader, grows once the shared string table is loaded.
+    // Measured when the workbook opens and when the table finishes loading, so reading it never waits on a load.
+    size_t GetMemoryFootprint() const { return MemoryFootprint.load(std::memory_order_relaxed); }
+
+    // Safe to call from several threads at once on the same reader
+    bool ReadRows(const std::string& InSheetName, const RowCallback& InCallback, std::string* OutError = nullptr) const;
+
+private:
+    bool ReadWorkbook();
+    bool LoadSharedStrings(std::string& OutError) const;
+
+private:
+    XlsxArchive Archive;
+
+    std::vector<std::string> SheetNames;
+    std::vector<std::string> SheetParts;
+    std::string SharedStringsPart;
+
+    // Loaded on first ReadRows, listing sheets never needs it
+    mutable std::vector<std::string> SharedStrings;
+    mutable std::mutex SharedStringsMutex;
+    mutable bool bSharedStringsLoaded = false;
+
+    mutable std::atomic<size_t> MemoryFootprint{ 0 };
+
+    std::string LastError;
+};
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Standalone entry point, only built by Core/CMakeLists.txt. UnrealBuildTool also sees this file, so it stays empty there.
+#if DATATABLECORE_TOOL
+
+#include "AllocationCounter.h"
+#include "SheetCache.h"
+#include "SheetCsvConverter.h"
+#include "XlsxSheetReader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+// Every operator new of the tool is counted per thread and handed to AllocationCounter, the array and nothrow forms end up here too
+static thread_local uint64_t ThreadAllocations = 0;
+
+void* operator new(size_t InSize)
+{
+    ThreadAllocations++;
+    if (void* Ptr = malloc(InSize != 0 ? InSize : 1))
+    {
+        return Ptr;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* InPtr) noexcept
+{
+    free(InPtr);
+}
+
+void operator delete(void* InPtr, size_t) noexcept
+{
+    free(InPtr);
+}
+
+static uint64_t ReadThreadAllocations()
+{
+    return ThreadAllocations;
+}
+
+int main(int Argc, char** Argv)
+{
+    if (Argc < 3)
+    {
+        fprintf(stderr, "Usage : XlsxToCsv <XlsxFilePath> <OutCsvFolderPath> [--cache] [SheetName...]\n");
+        return 2;
+    }
+
+    AllocationCounter::SetSource(&ReadThreadAllocations);
+
+    XlsxSheetReader Reader;
+    if (Reader.Open(filesystem::path(Argv[1])) == false)
+    {
+        fprintf(stderr, "Failed to open Xlsx file : %s\n", Reader.GetLastError().c_str());
+        return 1;
+    }
+
+    // --cache also writes each sheet's SheetCache next to its CSV
+    bool bWriteSheetCache = false;
+    vector<string> SheetNames;
+    for (int Index = 3; Index < Argc; Index++)
+    {
+        if (string_view(Argv[Index]) == "--cache")
+        {
+            bWriteSheetCache = true;
+            continue;
+        }
+        SheetNames.emplace_back(Argv[Index]);
+    }
+    if (SheetNames.empty())
+    {
+        SheetNames = Reader.GetSheetNames();
+    }
+
+    const filesystem::path CsvFolder(Argv[2]);
+    int FailedCount = 0;
+
+    for (const string& SheetName : SheetNames)
+    {
+        const chrono::steady_clock::time_point StartTime = chrono::steady_clock::now();
+
+        SheetCsvStats Stats;
+        string Error;
+        const filesystem::path SheetCachePath = bWriteSheetCache ? CsvFolder / (SheetName + SHEET_CACHE_EXTENSION) : filesystem::path();
+        if (SheetCsvConverter::Convert(Reader, SheetName, CsvFolder / (SheetName + ".csv"), Stats, Error, nullptr, SheetCachePath) == false)
+        {
+            fprintf(stderr, "Failed to create Csv file for sheet %s : %s\n", SheetName.c_str(), Error.c_str());
+            FailedCount++;
+            continue;
+        }
+        if (bWriteSheetCache && Stats.bSheetCacheWritten == false)
+        {
+            fprintf(stderr, "Failed to create sheet cache for sheet %s : %s\n", SheetName.c_str(), Stats.SheetCacheError.c_str());
+        }
+
+        const double Seconds = chrono::duration<double>(chrono::steady_clock::now() - StartTime).count();
+        printf("Converted sheet %s : %d rows in %.3f sec (%.0f rows/sec, %.1f MB/sec, %llu allocations in %d data rows)\n",
+            SheetName.c_str(), Stats.Rows, Seconds,
+            Seconds > 0.0 ? Stats.Rows / Seconds : 0.0, Seconds > 0.0 ? Stats.OutputBytes / (1024.0 * 1024.0) / Seconds : 0.0,
+            static_cast<unsigned long long>(Stats.DataRowAllocations), Stats.DataRows);
+    }
+
+    return FailedCount == 0 ? 0 : 1;
+}
+
+#endif
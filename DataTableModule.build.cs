@@ -19,11 +19,19 @@ public class DataTableModule : ModuleRules
                 Path.Combine(ThirdPartyPath, "include", "OpenXLSX", "external", "pugixml"),
             });
 
-        PublicAdditionalLibraries.Add(Path.Combine(ThirdPartyPath, "lib", "OpenXLSX", "OpenXLSX.lib"));
+        // OpenXLSX is only used by the Windows DOM path, the streaming converter in Core builds everywhere
+        if (Target.Platform == UnrealTargetPlatform.Win64)
+        {
+            PublicAdditionalLibraries.Add(Path.Combine(ThirdPartyPath, "lib", "OpenXLSX", "OpenXLSX.lib"));
+        }
 
-        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "UnrealEd", "Slate", "SlateCore", "EditorStyle", "ToolMenus", "Projects", "UMG", "AssetTools", "AssetRegistry" });
+        // Inflating sheet XML in chunks for XlsxSheetReader
+        AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
 
-        PublicIncludePaths.AddRange(new string[] {"DataTableModule/Module/Public", "DataTableModule/Widget/Public", "DataTableModule/Utility/Public" });
-        PrivateIncludePaths.AddRange(new string[] { "DataTableModule/Module/Private", "DataTableModule/Widget/Private", "DataTableModule/Utility/Private" });
+        PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "UnrealEd", "Slate", "SlateCore", "EditorStyle", "ToolMenus", "Projects", "UMG", "AssetTools", "AssetRegistry", "Json", "BlueprintGraph", "DirectoryWatcher" });
+
+        // Core is plain C++17 with no engine types, also built on its own by Core/CMakeLists.txt
+        PublicIncludePaths.AddRange(new string[] {"DataTableModule/Module/Public", "DataTableModule/Widget/Public", "DataTableModule/Utility/Public", "DataTableModule/Core/Public" });
+        PrivateIncludePaths.AddRange(new string[] { "DataTableModule/Module/Private", "DataTableModule/Widget/Private", "DataTableModule/Utility/Private", "DataTableModule/Core/Private" });
 	}
 }
\ No newline at end of file
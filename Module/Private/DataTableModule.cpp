@@ -13,6 +13,7 @@
 #include "Editor/EditorEngine.h"
 #include "DataTableManager.h"
 #include "EditorStyleSet.h"
+#include "RowStructIndex.h"
 
 static const FName DataTableManagerTabName("DataTableManager");
 
@@ -26,6 +27,8 @@ void FDataTableModule::StartupModule()
 		.SetDisplayName(LOCTEXT("FDataTableManagerTabTitle", "Data Table Manager"))
 		.SetMenuType(ETabSpawnerMenuType::Hidden);
 
+	RowStructIndex::Startup();
+
 	RegisterMenus();
 }
 
@@ -34,6 +37,8 @@ void FDataTableModule::ShutdownModule()
 	UToolMenus::UnRegisterStartupCallback(this);
 	UToolMenus::UnregisterOwner(this);
 	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(DataTableManagerTabName);
+
+	RowStructIndex::Shutdown();
 }
 
 
@@ -0,0 +1,791 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ConversionBenchmark.h"
+#include "XlsxManager.h"
+#include "StructGenerator.h"
+#include "DataTableAssetGenerator.h"
+#include "ConversionManifest.h"
+#include "DataTableRowDecoder.h"
+#include "AllocationCounter.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Engine/DataTable.h"
+#include "Engine/UserDefinedStruct.h"
+#include "Kismet2/StructureEditorUtils.h"
+#include "EdGraphSchema_K2.h"
+
+using namespace std;
+
+static FAutoConsoleCommand BenchmarkCSVCommand(
+    TEXT("DataTable.BenchmarkCSV"),
+    TEXT("Compare DOM and streaming Xlsx -> CSV conversion. Usage : DataTable.BenchmarkCSV <XlsxFilePath> <OutFolderPath>"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        if (Args.Num() < 2)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Usage : DataTable.BenchmarkCSV <XlsxFilePath> <OutFolderPath>"));
+            return;
+        }
+
+        ConversionBenchmark::CompareSheetReaders(Args[0], Args[1]);
+    }));
+
+static FAutoConsoleCommand BenchmarkSuiteCommand(
+    TEXT("DataTable.BenchmarkSuite"),
+    TEXT("Generate synthetic workbooks and time CSV conversion, struct generation and DataTable import. Usage : DataTable.BenchmarkSuite <OutFolderPath> [MaxRows]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        if (Args.Num() < 1)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Usage : DataTable.BenchmarkSuite <OutFolderPath> [MaxRows]"));
+            return;
+        }
+
+        // The 1M row scenario takes a while to generate, so it only runs when asked for
+        ConversionBenchmark::RunSuite(Args[0], Args.Num() >= 2 ? FCString::Atoi(*Args[1]) : 100000);
+    }));
+
+namespace
+{
+    struct FBenchmarkScenario
+    {
+        const TCHAR* Name;
+
+        // Data rows per sheet, below the type and name rows
+        int32 Rows;
+
+        // Value columns including the KEY column
+        int32 Columns;
+
+        // Share of the non KEY columns holding strings, the rest alternate int / float
+        float StringRatio;
+
+        // Distinct strings per workbook, 0 makes every string unique
+        int32 StringCardinality;
+
+        int32 SheetCount;
+    };
+
+    const FBenchmarkScenario Scenarios[] =
+    {
+        { TEXT("Rows_1K"), 1000, 20, 0.5f, 1000, 1 },
+        { TEXT("Rows_10K"), 10000, 20, 0.5f, 1000, 1 },
+        { TEXT("Rows_100K"), 100000, 20, 0.5f, 1000, 1 },
+        { TEXT("Rows_1M"), 1000000, 20, 0.5f, 1000, 1 },
+        { TEXT("Wide_150Columns"), 10000, 150, 0.5f, 1000, 1 },
+        { TEXT("NumbersOnly"), 100000, 20, 0.0f, 0, 1 },
+        { TEXT("StringsUnique"), 100000, 20, 1.0f, 0, 1 },
+        { TEXT("StringsLowCardinality"), 100000, 20, 1.0f, 16, 1 },
+        { TEXT("Sheets_8"), 10000, 20, 0.5f, 1000, 8 },
+    };
+
+    enum class EBenchmarkColumn : uint8
+    {
+        Int,
+        Float,
+        String,
+    };
+
+    EBenchmarkColumn GetColumnKind(const FBenchmarkScenario& InScenario, int32 InColumn)
+    {
+        if (InColumn == 0)
+        {
+            return EBenchmarkColumn::Int;
+        }
+
+        const int32 StringColumns = FMath::RoundToInt((InScenario.Columns - 1) * InScenario.StringRatio);
+        if (InColumn <= StringColumns)
+        {
+            return EBenchmarkColumn::String;
+        }
+
+        return InColumn % 2 == 0 ? EBenchmarkColumn::Int : EBenchmarkColumn::Float;
+    }
+
+    string GetColumnName(int32 InColumn)
+    {
+        return InColumn == 0 ? string("Id") : "Col" + to_string(InColumn);
+    }
+
+    // Forwards to the engine allocator and counts, per thread, the blocks asked for : installed as GMalloc while a benchmark runs.
+    // Blocks allocated before or after go through it unchanged, so it may be swapped in and out at any time.
+    class FCountingMalloc final : public FMalloc
+    {
+    public:
+        static uint64 ReadThreadAllocations()
+        {
+            return ThreadAllocations;
+        }
+
+        void SetInner(FMalloc* InInner)
+        {
+            Inner = InInner;
+        }
+
+        virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+        {
+            ThreadAllocations++;
+            return Inner->Malloc(Count, Alignment);
+        }
+
+        virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+        {
+            ThreadAllocations++;
+            return Inner->TryMalloc(Count, Alignment);
+        }
+
+        virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+        {
+            ThreadAllocations += Count != 0 ? 1 : 0;
+            return Inner->Realloc(Original, Count, Alignment);
+        }
+
+        virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+        {
+            ThreadAllocations += Count != 0 ? 1 : 0;
+            return Inner->TryRealloc(Original, Count, Alignment);
+        }
+
+        virtual void Free(void* Original) override
+        {
+            Inner->Free(Original);
+        }
+
+        virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+        {
+            return Inner->QuantizeSize(Count, Alignment);
+        }
+
+        virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+        {
+            return Inner->GetAllocationSize(Original, SizeOut);
+        }
+
+        virtual void Trim(bool bTrimThreadCaches) override
+        {
+            Inner->Trim(bTrimThreadCaches);
+        }
+
+        virtual void SetupTLSCachesOnCurrentThread() override
+        {
+            Inner->SetupTLSCachesOnCurrentThread();
+        }
+
+        virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+        {
+            Inner->ClearAndDisableTLSCachesOnCurrentThread();
+        }
+
+        virtual bool IsInternallyThreadSafe() const override
+        {
+            return Inner->IsInternallyThreadSafe();
+        }
+
+        virtual bool ValidateHeap() override
+        {
+            return Inner->ValidateHeap();
+        }
+
+        virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override
+        {
+            Inner->GetAllocatorStats(OutStats);
+        }
+
+        virtual void DumpAllocatorStats(FOutputDevice& Ar) override
+        {
+            Inner->DumpAllocatorStats(Ar);
+        }
+
+        virtual const TCHAR* GetDescriptiveName() override
+        {
+            return Inner->GetDescriptiveName();
+        }
+
+    private:
+        static thread_local uint64 ThreadAllocations;
+
+        FMalloc* Inner = nullptr;
+    };
+
+    thread_local uint64 FCountingMalloc::ThreadAllocations = 0;
+
+    // Counts the allocations of every thread while alive, read through AllocationCounter. Nested scopes keep the outer one's proxy.
+    // The proxy is never freed : another thread may still be inside it when GMalloc is put back.
+    class FAllocationCountingScope
+    {
+    public:
+        FAllocationCountingScope()
+        {
+            static FCountingMalloc* CountingMalloc = new FCountingMalloc();
+            if (GMalloc == CountingMalloc)
+            {
+                return;
+            }
+
+            CountingMalloc->SetInner(GMalloc);
+            PreviousMalloc = GMalloc;
+            GMalloc = CountingMalloc;
+            AllocationCounter::SetSource(&FCountingMalloc::ReadThreadAllocations);
+        }
+
+        ~FAllocationCountingScope()
+        {
+            if (PreviousMalloc != nullptr)
+            {
+                AllocationCounter::SetSource(nullptr);
+                GMalloc = PreviousMalloc;
+            }
+        }
+
+    private:
+        FMalloc* PreviousMalloc = nullptr;
+    };
+
+    struct FStageResult
+    {
+        FString Stage;
+        double Seconds = 0.0;
+        int64 Rows = 0;
+        int64 Bytes = 0;
+
+        // Heap allocations made by the stage on the calling thread, every stage runs there. -1 when nothing counts.
+        int64 Allocations = -1;
+
+        uint64 PeakGrowth = 0;
+    };
+
+    // PeakUsedPhysical only grows, so a stage that does not raise it reports 0
+    template<typename FuncType>
+    FStageResult MeasureStage(const TCHAR* InStage, FuncType&& InFunc)
+    {
+        FStageResult Result;
+        Result.Stage = InStage;
+
+        const uint64 PeakBefore = FPlatformMemory::GetStats().PeakUsedPhysical;
+        const uint64 AllocationsBefore = AllocationCounter::Read();
+        const double StartTime = FPlatformTime::Seconds();
+        InFunc(Result);
+        Result.Seconds = FPlatformTime::Seconds() - StartTime;
+        Result.Allocations = AllocationCounter::IsCounting() ? static_cast<int64>(AllocationCounter::Read() - AllocationsBefore) : -1;
+        Result.PeakGrowth = FPlatformMemory::GetStats().PeakUsedPhysical - PeakBefore;
+
+        UE_LOG(LogTemp, Display, TEXT("  %-8s %.3f sec | %.0f rows/sec | %.1f MB/sec | %lld allocations | peak +%llu KB"),
+            *Result.Stage, Result.Seconds,
+            Result.Seconds > 0.0 ? Result.Rows / Result.Seconds : 0.0,
+            Result.Seconds > 0.0 ? Result.Bytes / (1024.0 * 1024.0) / Result.Seconds : 0.0,
+            Result.Allocations, Result.PeakGrowth / 1024);
+
+        return Result;
+    }
+
+    TSharedRef<FJsonObject> ToJson(const FStageResult& InResult)
+    {
+        TSharedRef<FJsonObject> Stage = MakeShared<FJsonObject>();
+        Stage->SetStringField(TEXT("Stage"), InResult.Stage);
+        Stage->SetNumberField(TEXT("Seconds"), InResult.Seconds);
+        Stage->SetNumberField(TEXT("Rows"), static_cast<double>(InResult.Rows));
+        Stage->SetNumberField(TEXT("RowsPerSec"), InResult.Seconds > 0.0 ? InResult.Rows / InResult.Seconds : 0.0);
+        Stage->SetNumberField(TEXT("Bytes"), static_cast<double>(InResult.Bytes));
+        Stage->SetNumberField(TEXT("MBPerSec"), InResult.Seconds > 0.0 ? InResult.Bytes / (1024.0 * 1024.0) / InResult.Seconds : 0.0);
+        Stage->SetNumberField(TEXT("Allocations"), static_cast<double>(InResult.Allocations));
+        Stage->SetNumberField(TEXT("PeakGrowthKB"), static_cast<double>(InResult.PeakGrowth / 1024));
+        return Stage;
+    }
+
+    // Transient row struct with one member per CSV column, so import runs without a compiled USTRUCT
+    UUserDefinedStruct* CreateBenchmarkRowStruct(const FBenchmarkScenario& InScenario)
+    {
+        UUserDefinedStruct* RowStruct = FStructureEditorUtils::CreateUserDefinedStruct(GetTransientPackage(),
+            MakeUniqueObjectName(GetTransientPackage(), UUserDefinedStruct::StaticClass(), TEXT("BenchmarkRow")), RF_Transient);
+
+        // A new struct starts with one placeholder member, removed once ours exist
+        const FGuid PlaceholderGuid = FStructureEditorUtils::GetVarDesc(RowStruct)[0].VarGuid;
+
+        for (int32 Column = 0; Column < InScenario.Columns; Column++)
+        {
+            FEdGraphPinType PinType;
+            switch (GetColumnKind(InScenario, Column))
+            {
+            case EBenchmarkColumn::Int:
+                PinType.PinCategory = UEdGraphSchema_K2::PC_Int;
+                break;
+            case EBenchmarkColumn::Float:
+                PinType.PinCategory = UEdGraphSchema_K2::PC_Real;
+                PinType.PinSubCategory = UEdGraphSchema_K2::PC_Double;
+                break;
+            default:
+                PinType.PinCategory = UEdGraphSchema_K2::PC_String;
+                break;
+            }
+
+            FStructureEditorUtils::AddVariable(RowStruct, PinType);
+            FStructureEditorUtils::RenameVariable(RowStruct, FStructureEditorUtils::GetVarDesc(RowStruct).Last().VarGuid, GetColumnName(Column).c_str());
+        }
+
+        FStructureEditorUtils::RemoveVariable(RowStruct, PlaceholderGuid);
+        return RowStruct;
+    }
+
+    // The field table StructGenerator emits for a compiled row struct. The benchmark's row structs only exist at runtime,
+    // so no generated decoder can be compiled for them : the same table is built from their properties instead.
+    struct FBenchmarkRowDecoder
+    {
+        TArray<FString> Names;
+        TArray<FDataTableDecoderField> Fields;
+        TUniquePtr<FDataTableRowDecoder> Decoder;
+    };
+
+    TUniquePtr<FBenchmarkRowDecoder> CreateBenchmarkRowDecoder(const UScriptStruct* InRowStruct)
+    {
+        TUniquePtr<FBenchmarkRowDecoder> Result = MakeUnique<FBenchmarkRowDecoder>();
+
+        // Field names point into Names, which must not grow once they are taken
+        int32 PropertyCount = 0;
+        for (TFieldIterator<FProperty> It(InRowStruct); It; ++It)
+        {
+            PropertyCount++;
+        }
+        Result->Names.Reserve(PropertyCount);
+
+        for (TFieldIterator<FProperty> It(InRowStruct); It; ++It)
+        {
+            EDataTableFieldType Type;
+            if (It->IsA<FIntProperty>())
+            {
+                Type = EDataTableFieldType::Int32;
+            }
+            else if (It->IsA<FDoubleProperty>())
+            {
+                Type = EDataTableFieldType::Double;
+            }
+            else if (It->IsA<FStrProperty>())
+            {
+                Type = EDataTableFieldType::String;
+            }
+            else
+            {
+                continue;
+            }
+
+            const FString& Name = Result->Names.Add_GetRef(It->GetName());
+            Result->Fields.Add(FDataTableDecoderField{ *Name, static_cast<uint32>(It->GetOffset_ForInternal()), Type });
+        }
+
+        Result->Decoder = MakeUnique<FDataTableRowDecoder>(InRowStruct, Result->Fields);
+        return Result;
+    }
+}
+
+ConversionBenchmark::ConversionBenchmark()
+{
+}
+
+ConversionBenchmark::~ConversionBenchmark()
+{
+}
+
+bool ConversionBenchmark::CompareSheetReaders(const FString& InXlsxFilePath, const FString& OutFolderPath)
+{
+#if PLATFORM_WINDOWS
+    if (FPaths::FileExists(InXlsxFilePath) == false)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Invalid file path for XLSX"));
+        return false;
+    }
+
+    const FString DomFolder = FPaths::Combine(OutFolderPath, TEXT("Benchmark_DOM"));
+    const FString StreamFolder = FPaths::Combine(OutFolderPath, TEXT("Benchmark_Stream"));
+    IFileManager::Get().MakeDirectory(*DomFolder, true);
+    IFileManager::Get().MakeDirectory(*StreamFolder, true);
+
+    try
+    {
+        XlsxSheetReader Reader;
+        if (Reader.Open(filesystem::path(*InXlsxFilePath)) == false)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Failed to open Xlsx file : %s"), UTF8_TO_TCHAR(Reader.GetLastError().c_str()));
+            return false;
+        }
+
+        OpenXLSX::XLDocument Doc;
+        Doc.open(TCHAR_TO_UTF8(*InXlsxFilePath));
+
+        bool bAllIdentical = true;
+
+        // Real heap allocations behind the streaming conversion's per row count
+        const FAllocationCountingScope CountingScope;
+
+        for (const string& SheetName : Reader.GetSheetNames())
+        {
+            // PeakUsedPhysical only grows, so a stage that does not raise it reports 0
+            const uint64 PeakBeforeDom = FPlatformMemory::GetStats().PeakUsedPhysical;
+            const double DomStart = FPlatformTime::Seconds();
+            {
+                OpenXLSX::XLWorksheet Wks = Doc.workbook().worksheet(SheetName);
+                XlsxManager::CreateCSV(Wks, DomFolder);
+            }
+            const double DomTime = FPlatformTime::Seconds() - DomStart;
+            const uint64 DomPeakGrowth = FPlatformMemory::GetStats().PeakUsedPhysical - PeakBeforeDom;
+
+            FCsvConvertStats Stats;
+            const uint64 PeakBeforeStream = FPlatformMemory::GetStats().PeakUsedPhysical;
+            const double StreamStart = FPlatformTime::Seconds();
+            XlsxManager::CreateCSV(Reader, SheetName, StreamFolder, &Stats);
+            const int32 RowCount = Stats.Rows;
+            const double StreamTime = FPlatformTime::Seconds() - StreamStart;
+            const uint64 StreamPeakGrowth = FPlatformMemory::GetStats().PeakUsedPhysical - PeakBeforeStream;
+
+            const FString CsvName = FString(SheetName.c_str()) + CSV_EXTENSION;
+            TArray<uint8> DomBytes, StreamBytes;
+            FFileHelper::LoadFileToArray(DomBytes, *FPaths::Combine(DomFolder, CsvName));
+            FFileHelper::LoadFileToArray(StreamBytes, *FPaths::Combine(StreamFolder, CsvName));
+            const bool bIdentical = DomBytes == StreamBytes;
+            bAllIdentical &= bIdentical;
+
+            const double MegaBytes = Stats.OutputBytes / (1024.0 * 1024.0);
+            UE_LOG(LogTemp, Display, TEXT("[%s] %d rows, %.1f MB | DOM %.3f sec (%.0f rows/sec, %.1f MB/sec, peak +%llu KB) | Stream %.3f sec (%.0f rows/sec, %.1f MB/sec, peak +%llu KB, %llu allocations in %d data rows) | %s"),
+                *CsvName, RowCount, MegaBytes,
+                DomTime, DomTime > 0.0 ? RowCount / DomTime : 0.0, DomTime > 0.0 ? MegaBytes / DomTime : 0.0, DomPeakGrowth / 1024,
+                StreamTime, StreamTime > 0.0 ? RowCount / StreamTime : 0.0, StreamTime > 0.0 ? MegaBytes / StreamTime : 0.0, StreamPeakGrowth / 1024, Stats.DataRowAllocations, Stats.DataRows,
+                bIdentical ? TEXT("identical") : TEXT("DIFFERENT"));
+        }
+
+        Doc.close();
+        return bAllIdentical;
+    }
+    catch (const exception& e)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Benchmark failed : %s"), *FString(e.what()));
+        return false;
+    }
+#endif
+    UE_LOG(LogTemp, Error, TEXT("This feature is only available on Windows operating systems."));
+    return false;
+}
+
+#if PLATFORM_WINDOWS
+static bool GenerateBenchmarkWorkbook(const FBenchmarkScenario& InScenario, const FString& InFilePath)
+{
+    OpenXLSX::XLDocument Doc;
+    Doc.create(TCHAR_TO_UTF8(*InFilePath), true);
+
+    vector<OpenXLSX::XLCellValue> Values(InScenario.Columns);
+
+    for (int32 SheetIndex = 0; SheetIndex < InScenario.SheetCount; SheetIndex++)
+    {
+        const string SheetName = "Bench" + to_string(SheetIndex + 1);
+        if (SheetIndex == 0)
+        {
+            Doc.workbook().worksheet("Sheet1").setName(SheetName);
+        }
+        else
+        {
+            Doc.workbook().addWorksheet(SheetName);
+        }
+
+        OpenXLSX::XLWorksheet Wks = Doc.workbook().worksheet(SheetName);
+
+        // Type row with the KEY marker, then the name row
+        for (int32 Column = 0; Column < InScenario.Columns; Column++)
+        {
+            switch (GetColumnKind(InScenario, Column))
+            {
+            case EBenchmarkColumn::Int:
+                Values[Column] = Column == 0 ? "int32=KEY" : "int32";
+                break;
+            case EBenchmarkColumn::Float:
+                Values[Column] = "double";
+                break;
+            default:
+                Values[Column] = "FString";
+                break;
+            }
+        }
+        Wks.row(1).values() = Values;
+
+        for (int32 Column = 0; Column < InScenario.Columns; Column++)
+        {
+            Values[Column] = GetColumnName(Column);
+        }
+        Wks.row(2).values() = Values;
+
+        for (int32 Row = 0; Row < InScenario.Rows; Row++)
+        {
+            for (int32 Column = 0; Column < InScenario.Columns; Column++)
+            {
+                switch (GetColumnKind(InScenario, Column))
+                {
+                case EBenchmarkColumn::Int:
+                    Values[Column] = static_cast<int64_t>(Column == 0 ? Row + 1 : Row * 7 + Column);
+                    break;
+                case EBenchmarkColumn::Float:
+                    Values[Column] = Row * 0.25 + Column;
+                    break;
+                default:
+                {
+                    const int64 StringId = InScenario.StringCardinality == 0
+                        ? static_cast<int64>(Row) * InScenario.Columns + Column
+                        : (static_cast<int64>(Row) * 31 + Column * 17) % InScenario.StringCardinality;
+                    Values[Column] = "S" + to_string(StringId);
+                    break;
+                }
+                }
+            }
+            Wks.row(Row + 3).values() = Values;
+        }
+    }
+
+    Doc.save();
+    Doc.close();
+    return true;
+}
+#endif
+
+bool ConversionBenchmark::RunSuite(const FString& OutFolderPath, int32 InMaxRows)
+{
+#if PLATFORM_WINDOWS
+    const FString WorkbookFolder = FPaths::Combine(OutFolderPath, TEXT("Workbooks"));
+    IFileManager::Get().MakeDirectory(*WorkbookFolder, true);
+
+    TArray<TSharedPtr<FJsonValue>> ScenarioResults;
+
+    // Every stage reports the heap allocations it made
+    const FAllocationCountingScope CountingScope;
+
+    try
+    {
+        for (const FBenchmarkScenario& Scenario : Scenarios)
+        {
+            if (Scenario.Rows > InMaxRows)
+            {
+                continue;
+            }
+
+            const FString ScenarioFolder = FPaths::Combine(OutFolderPath, Scenario.Name);
+            const FString CsvFolder = FPaths::Combine(ScenarioFolder, TEXT("CSV"));
+            const FString StructFolder = FPaths::Combine(ScenarioFolder, TEXT("Struct"));
+            IFileManager::Get().MakeDirectory(*CsvFolder, true);
+            IFileManager::Get().MakeDirectory(*StructFolder, true);
+
+            // Generated once and reused by later runs, the file name is the scenario name
+            const FString WorkbookPath = FPaths::Combine(WorkbookFolder, FString(Scenario.Name) + TEXT(".xlsx"));
+            if (FPaths::FileExists(WorkbookPath) == false)
+            {
+                const double GenerateStart = FPlatformTime::Seconds();
+                GenerateBenchmarkWorkbook(Scenario, WorkbookPath);
+                UE_LOG(LogTemp, Display, TEXT("Generated %s in %.3f sec"), *WorkbookPath, FPlatformTime::Seconds() - GenerateStart);
+            }
+
+            UE_LOG(LogTemp, Display, TEXT("[%s] %d rows x %d columns x %d sheets, %.0f%% strings, %d distinct strings"),
+                Scenario.Name, Scenario.Rows, Scenario.Columns, Scenario.SheetCount, Scenario.StringRatio * 100.0f, Scenario.StringCardinality);
+
+            XlsxSheetReader Reader;
+            if (Reader.Open(filesystem::path(*WorkbookPath)) == false)
+            {
+                UE_LOG(LogTemp, Error, TEXT("Failed to open Xlsx file : %s"), UTF8_TO_TCHAR(Reader.GetLastError().c_str()));
+                return false;
+            }
+
+            TArray<FStageResult> Stages;
+
+            Stages.Add(MeasureStage(TEXT("CSV"), [&](FStageResult& Result)
+            {
+                for (const string& SheetName : Reader.GetSheetNames())
+                {
+                    FCsvConvertStats Stats;
+                    XlsxManager::CreateCSV(Reader, SheetName, CsvFolder, &Stats);
+                    Result.Rows += Stats.Rows;
+                    Result.Bytes += Stats.OutputBytes;
+                }
+            }));
+
+            Stages.Add(MeasureStage(TEXT("Struct"), [&](FStageResult& Result)
+            {
+                StructGenerator::GenerateStructFromXlsx(WorkbookPath, CsvFolder, StructFolder);
+                Result.Rows = Reader.GetSheetNames().size();
+            }));
+
+            // Import into transient tables : CSV load and row parsing, without asset creation and package save
+            TArray<UUserDefinedStruct*> RowStructs;
+            for (size_t SheetIndex = 0; SheetIndex < Reader.GetSheetNames().size(); SheetIndex++)
+            {
+                RowStructs.Add(CreateBenchmarkRowStruct(Scenario));
+            }
+
+            // Same path as the import : LoadForImport then FillDataTable, into transient tables without asset creation and package save.
+            // The structs only get a row decoder in DecodedImport, where the CSV lines are split without an FString copy.
+            auto ImportCSVs = [&](FStageResult& Result)
+            {
+                for (int32 SheetIndex = 0; SheetIndex < RowStructs.Num(); SheetIndex++)
+                {
+                    const FString CsvPath = FPaths::Combine(CsvFolder, FString(Reader.GetSheetNames()[SheetIndex].c_str()) + CSV_EXTENSION);
+
+                    FDataTableImportData Data;
+                    if (DataTableAssetGanerator::LoadForImport(CsvPath, FString(), FString(), Data, nullptr, DataTableRowDecoderRegistry::Find(RowStructs[SheetIndex]) != nullptr) == false)
+                    {
+                        continue;
+                    }
+
+                    UDataTable* Table = NewObject<UDataTable>(GetTransientPackage(), NAME_None, RF_Transient);
+                    Table->RowStruct = RowStructs[SheetIndex];
+                    TArray<FString> Problems;
+                    DataTableAssetGanerator::FillDataTable(Table, Data, Problems);
+
+                    Result.Rows += Table->GetRowMap().Num();
+                    Result.Bytes += IFileManager::Get().FileSize(*CsvPath);
+                }
+            };
+
+            Stages.Add(MeasureStage(TEXT("Import"), ImportCSVs));
+
+            // Same CSVs with a row decoder registered for each struct, compare with Import
+            TArray<TUniquePtr<FBenchmarkRowDecoder>> RowDecoders;
+            for (UUserDefinedStruct* RowStruct : RowStructs)
+            {
+                RowDecoders.Add(CreateBenchmarkRowDecoder(RowStruct));
+            }
+
+            auto RegisterRowDecoders = [&RowDecoders]()
+            {
+                TArray<TUniquePtr<FDataTableRowDecoderRegistration>> Registrations;
+                for (const TUniquePtr<FBenchmarkRowDecoder>& RowDecoder : RowDecoders)
+                {
+                    Registrations.Add(MakeUnique<FDataTableRowDecoderRegistration>(*RowDecoder->Decoder));
+                }
+                return Registrations;
+            };
+
+            Stages.Add(MeasureStage(TEXT("DecodedImport"), [&](FStageResult& Result)
+            {
+                const TArray<TUniquePtr<FDataTableRowDecoderRegistration>> Registrations = RegisterRowDecoders();
+                ImportCSVs(Result);
+            }));
+
+            // Workbook straight into the same transient tables, compare with CSV + Import
+            Stages.Add(MeasureStage(TEXT("Direct"), [&](FStageResult& Result)
+            {
+                for (int32 SheetIndex = 0; SheetIndex < RowStructs.Num(); SheetIndex++)
+                {
+                    SheetTable Table;
+                    if (DataTableAssetGanerator::LoadSheetForImport(WorkbookPath, Reader.GetSheetNames()[SheetIndex].c_str(), Table) == false)
+                    {
+                        continue;
+                    }
+
+                    UDataTable* DataTable = NewObject<UDataTable>(GetTransientPackage(), NAME_None, RF_Transient);
+                    DataTable->RowStruct = RowStructs[SheetIndex];
+                    TArray<FString> Problems;
+                    DataTableAssetGanerator::FillDataTableFromSheet(DataTable, Table, Problems);
+
+                    Result.Rows += DataTable->GetRowMap().Num();
+                    Result.Bytes += Table.GetMemoryFootprint();
+                }
+            }));
+
+            Stages.Add(MeasureStage(TEXT("DirectDecoded"), [&](FStageResult& Result)
+            {
+                const TArray<TUniquePtr<FDataTableRowDecoderRegistration>> Registrations = RegisterRowDecoders();
+                for (int32 SheetIndex = 0; SheetIndex < RowStructs.Num(); SheetIndex++)
+                {
+                    SheetTable Table;
+                    if (DataTableAssetGanerator::LoadSheetForImport(WorkbookPath, Reader.GetSheetNames()[SheetIndex].c_str(), Table) == false)
+                    {
+                        continue;
+                    }
+
+                    UDataTable* DataTable = NewObject<UDataTable>(GetTransientPackage(), NAME_None, RF_Transient);
+                    DataTable->RowStruct = RowStructs[SheetIndex];
+                    TArray<FString> Problems;
+                    DataTableAssetGanerator::FillDataTableFromSheet(DataTable, Table, Problems);
+
+                    Result.Rows += DataTable->GetRowMap().Num();
+                    Result.Bytes += Table.GetMemoryFootprint();
+                }
+            }));
+
+            // Conversion that also writes the sheet caches, then import from them instead of the CSV text
+            Stages.Add(MeasureStage(TEXT("CSV+Cache"), [&](FStageResult& Result)
+            {
+                for (const string& SheetName : Reader.GetSheetNames())
+                {
+                    FCsvConvertStats Stats;
+                    XlsxManager::CreateCSV(Reader, SheetName, CsvFolder, &Stats, nullptr, nullptr, true);
+                    Result.Rows += Stats.Rows;
+                    Result.Bytes += Stats.OutputBytes;
+                }
+            }));
+
+            Stages.Add(MeasureStage(TEXT("CacheImport"), [&](FStageResult& Result)
+            {
+                for (int32 SheetIndex = 0; SheetIndex < RowStructs.Num(); SheetIndex++)
+                {
+                    const FString SheetCachePath = FPaths::Combine(CsvFolder, FString(Reader.GetSheetNames()[SheetIndex].c_str()) + TEXT(SHEET_CACHE_EXTENSION));
+
+                    SheetCache Cache;
+                    if (DataTableAssetGanerator::LoadSheetCacheForImport(SheetCachePath, Cache) == false)
+                    {
+                        continue;
+                    }
+
+                    UDataTable* DataTable = NewObject<UDataTable>(GetTransientPackage(), NAME_None, RF_Transient);
+                    DataTable->RowStruct = RowStructs[SheetIndex];
+                    TArray<FString> Problems;
+                    DataTableAssetGanerator::FillDataTableFromSheetCache(DataTable, Cache, Problems);
+
+                    Result.Rows += DataTable->GetRowMap().Num();
+                    Result.Bytes += IFileManager::Get().FileSize(*SheetCachePath);
+                }
+            }));
+
+            TArray<TSharedPtr<FJsonValue>> StageValues;
+            for (const FStageResult& Stage : Stages)
+            {
+                StageValues.Add(MakeShared<FJsonValueObject>(ToJson(Stage)));
+            }
+
+            TSharedRef<FJsonObject> ScenarioObject = MakeShared<FJsonObject>();
+            ScenarioObject->SetStringField(TEXT("Name"), Scenario.Name);
+            ScenarioObject->SetNumberField(TEXT("Rows"), Scenario.Rows);
+            ScenarioObject->SetNumberField(TEXT("Columns"), Scenario.Columns);
+            ScenarioObject->SetNumberField(TEXT("StringRatio"), Scenario.StringRatio);
+            ScenarioObject->SetNumberField(TEXT("StringCardinality"), Scenario.StringCardinality);
+            ScenarioObject->SetNumberField(TEXT("Sheets"), Scenario.SheetCount);
+            ScenarioObject->SetNumberField(TEXT("WorkbookBytes"), static_cast<double>(IFileManager::Get().FileSize(*WorkbookPath)));
+            ScenarioObject->SetArrayField(TEXT("Stages"), StageValues);
+            ScenarioResults.Add(MakeShared<FJsonValueObject>(ScenarioObject));
+        }
+    }
+    catch (const exception& e)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Benchmark failed : %s"), *FString(e.what()));
+        return false;
+    }
+
+    TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+    Root->SetNumberField(TEXT("ConverterVersion"), CSV_CONVERTER_VERSION);
+    Root->SetStringField(TEXT("Date"), FDateTime::UtcNow().ToIso8601());
+    Root->SetStringField(TEXT("Platform"), FPlatformProperties::IniPlatformName());
+    Root->SetNumberField(TEXT("MaxRows"), InMaxRows);
+    Root->SetArrayField(TEXT("Scenarios"), ScenarioResults);
+
+    FString Json;
+    FJsonSerializer::Serialize(Root, TJsonWriterFactory<>::Create(&Json));
+
+    const FString ResultPath = FPaths::Combine(OutFolderPath, TEXT("BenchmarkResults.json"));
+    if (FFileHelper::SaveStringToFile(Json, *ResultPath) == false)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to save %s"), *ResultPath);
+        return false;
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("Benchmark results saved to %s"), *ResultPath);
+    return true;
+#endif
+    UE_LOG(LogTemp, Error, TEXT("This feature is only available on Windows operating systems."));
+    return false;
+}
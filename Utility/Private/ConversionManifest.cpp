@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ConversionManifest.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+#include "zlib.h"
+
+// Serializes read-merge-write of manifests from conversions running at the same time in this process.
+// Other processes are not locked out : the file is always replaced whole, but records one of them merged
+// between our load and our move are lost, so one CSV folder should be converted by one process at a time.
+static FCriticalSection ManifestLock;
+
+ConversionManifest::ConversionManifest()
+{
+}
+
+ConversionManifest::~ConversionManifest()
+{
+}
+
+static FString GetManifestPath(const FString& InCSVFolderPath)
+{
+    return FPaths::Combine(InCSVFolderPath, TEXT(CSV_MANIFEST_FILENAME));
+}
+
+// 64-bit values are written as strings, JSON numbers are doubles
+static int64 ReadInt64(const TSharedPtr<FJsonObject>& InObject, const TCHAR* InField)
+{
+    int64 Value = 0;
+    LexFromString(Value, *InObject->GetStringField(InField));
+    return Value;
+}
+
+static void ReadStrings(const TSharedPtr<FJsonObject>& InObject, const TCHAR* InField, TArray<FString>& OutStrings)
+{
+    const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+    if (InObject->TryGetArrayField(InField, Values))
+    {
+        for (const TSharedPtr<FJsonValue>& Value : *Values)
+        {
+            OutStrings.Add(Value->AsString());
+        }
+    }
+}
+
+static TArray<TSharedPtr<FJsonValue>> WriteStrings(const TArray<FString>& InStrings)
+{
+    TArray<TSharedPtr<FJsonValue>> Values;
+    for (const FString& String : InStrings)
+    {
+        Values.Add(MakeShared<FJsonValueString>(String));
+    }
+    return Values;
+}
+
+static void LoadUnlocked(const FString& InCSVFolderPath, TMap<FString, FConversionRecord>& OutRecords)
+{
+    OutRecords.Empty();
+
+    FString Json;
+    if (FFileHelper::LoadFileToString(Json, *GetManifestPath(InCSVFolderPath)) == false)
+    {
+        return;
+    }
+
+    TSharedPtr<FJsonObject> Root;
+    if (FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Root) == false || Root.IsValid() == false)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Ignoring unreadable %s"), *GetManifestPath(InCSVFolderPath));
+        return;
+    }
+
+    const TSharedPtr<FJsonObject>* Sheets = nullptr;
+    if (Root->TryGetObjectField(TEXT("Sheets"), Sheets) == false)
+    {
+        return;
+    }
+
+    for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*Sheets)->Values)
+    {
+        const TSharedPtr<FJsonObject> Sheet = Pair.Value->AsObject();
+        if (Sheet.IsValid() == false)
+        {
+            continue;
+        }
+
+        FConversionRecord& Record = OutRecords.Add(Pair.Key);
+        Record.WorkbookPath = Sheet->GetStringField(TEXT("Workbook"));
+        Record.WorkbookTimeStamp = FDateTime(ReadInt64(Sheet, TEXT("WorkbookTimeStamp")));
+        Record.WorkbookSize = ReadInt64(Sheet, TEXT("WorkbookSize"));
+        Record.SheetCrc = static_cast<uint32>(Sheet->GetNumberField(TEXT("SheetCrc")));
+        Record.SharedStringsCrc = static_cast<uint32>(Sheet->GetNumberField(TEXT("SharedStringsCrc")));
+        Record.ConverterVersion = static_cast<int32>(Sheet->GetNumberField(TEXT("ConverterVersion")));
+        Record.OutputCrc = static_cast<uint32>(Sheet->GetNumberField(TEXT("OutputCrc")));
+        Record.OutputSize = ReadInt64(Sheet, TEXT("OutputSize"));
+        Record.OutputTimeStamp = FDateTime(ReadInt64(Sheet, TEXT("OutputTimeStamp")));
+
+        ReadStrings(Sheet, TEXT("Types"), Record.Schema.Types);
+        ReadStrings(Sheet, TEXT("Names"), Record.Schema.Names);
+        Sheet->TryGetNumberField(TEXT("KeyColumn"), Record.Schema.KeyColumn);
+    }
+}
+
+void ConversionManifest::Load(const FString& InCSVFolderPath, TMap<FString, FConversionRecord>& OutRecords)
+{
+    FScopeLock Lock(&ManifestLock);
+    LoadUnlocked(InCSVFolderPath, OutRecords);
+}
+
+bool ConversionManifest::Update(const FString& InCSVFolderPath, const TMap<FString, FConversionRecord>& InRecords)
+{
+    if (InRecords.Num() == 0)
+    {
+        return true;
+    }
+
+    FScopeLock Lock(&ManifestLock);
+
+    TMap<FString, FConversionRecord> Records;
+    LoadUnlocked(InCSVFolderPath, Records);
+    Records.Append(InRecords);
+    Records.KeySort(TLess<FString>());
+
+    TSharedRef<FJsonObject> Sheets = MakeShared<FJsonObject>();
+    for (const TPair<FString, FConversionRecord>& Pair : Records)
+    {
+        const FConversionRecord& Record = Pair.Value;
+
+        TSharedRef<FJsonObject> Sheet = MakeShared<FJsonObject>();
+        Sheet->SetStringField(TEXT("Workbook"), Record.WorkbookPath);
+        Sheet->SetStringField(TEXT("WorkbookTimeStamp"), LexToString(Record.WorkbookTimeStamp.GetTicks()));
+        Sheet->SetStringField(TEXT("WorkbookSize"), LexToString(Record.WorkbookSize));
+        Sheet->SetNumberField(TEXT("SheetCrc"), Record.SheetCrc);
+        Sheet->SetNumberField(TEXT("SharedStringsCrc"), Record.SharedStringsCrc);
+        Sheet->SetNumberField(TEXT("ConverterVersion"), Record.ConverterVersion);
+        Sheet->SetNumberField(TEXT("OutputCrc"), Record.OutputCrc);
+        Sheet->SetStringField(TEXT("OutputSize"), LexToString(Record.OutputSize));
+        Sheet->SetStringField(TEXT("OutputTimeStamp"), LexToString(Record.OutputTimeStamp.GetTicks()));
+        Sheet->SetArrayField(TEXT("Types"), WriteStrings(Record.Schema.Types));
+        Sheet->SetArrayField(TEXT("Names"), WriteStrings(Record.Schema.Names));
+        Sheet->SetNumberField(TEXT("KeyColumn"), Record.Schema.KeyColumn);
+        Sheets->SetObjectField(Pair.Key, Sheet);
+    }
+
+    TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+    Root->SetNumberField(TEXT("Version"), 1);
+    Root->SetObjectField(TEXT("Sheets"), Sheets);
+
+    FString Json;
+    FJsonSerializer::Serialize(Root, TJsonWriterFactory<>::Create(&Json));
+
+    // Written next to the manifest and moved over it like CsvFileWriter does, so a reader never sees half a file.
+    // The temp name is unique per write, two processes saving at once each replace the manifest whole.
+    const FString ManifestPath = GetManifestPath(InCSVFolderPath);
+    const FString TempPath = FPaths::CreateTempFilename(*InCSVFolderPath, TEXT("CSVManifest"), TEXT(".tmp"));
+    if (FFileHelper::SaveStringToFile(Json, *TempPath) == false || IFileManager::Get().Move(*ManifestPath, *TempPath, true) == false)
+    {
+        IFileManager::Get().Delete(*TempPath, false, false, true);
+        UE_LOG(LogTemp, Error, TEXT("Failed to save %s"), *ManifestPath);
+        return false;
+    }
+
+    return true;
+}
+
+bool ConversionManifest::IsUpToDate(const FConversionRecord& InRecorded, const FConversionRecord& InCurrent, const FString& InCSVFilePath)
+{
+    // Workbook timestamp and size are informational : re-saving without edits keeps the entry CRCs
+    if (InRecorded.ConverterVersion != CSV_CONVERTER_VERSION
+        || InRecorded.WorkbookPath != InCurrent.WorkbookPath
+        || InRecorded.SheetCrc != InCurrent.SheetCrc
+        || InRecorded.SharedStringsCrc != InCurrent.SharedStringsCrc)
+    {
+        return false;
+    }
+
+    IFileManager& FileManager = IFileManager::Get();
+    const int64 OutputSize = FileManager.FileSize(*InCSVFilePath);
+    if (OutputSize != InRecorded.OutputSize)
+    {
+        return false;
+    }
+
+    // Untouched CSV, no need to read it
+    if (FileManager.GetTimeStamp(*InCSVFilePath) == InRecorded.OutputTimeStamp)
+    {
+        return true;
+    }
+
+    TArray<uint8> Output;
+    return FFileHelper::LoadFileToArray(Output, *InCSVFilePath)
+        && static_cast<uint32>(crc32(0L, Output.GetData(), static_cast<uInt>(Output.Num()))) == InRecorded.OutputCrc;
+}
+
+bool ConversionManifest::FindSchema(const FConversionRecord& InRecorded, const FString& InCSVFilePath, FSheetSchema& OutSchema)
+{
+    if (InRecorded.ConverterVersion != CSV_CONVERTER_VERSION || InRecorded.Schema.IsValid() == false)
+    {
+        return false;
+    }
+
+    // Unlike IsUpToDate a touched CSV is not hashed : reading its two header lines is cheaper
+    IFileManager& FileManager = IFileManager::Get();
+    if (FileManager.FileSize(*InCSVFilePath) != InRecorded.OutputSize || FileManager.GetTimeStamp(*InCSVFilePath) != InRecorded.OutputTimeStamp)
+    {
+        return false;
+    }
+
+    OutSchema = InRecorded.Schema;
+    return true;
+}
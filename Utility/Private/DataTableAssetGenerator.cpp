@@ -3,39 +3,813 @@
 #include "DataTableAssetGenerator.h"
 #include "Misc/FileHelper.h"
 #include "HAL/PlatformFileManager.h"
+#include "HAL/FileManager.h"
 #include "Factories/DataTableFactory.h"
 #include "AssetToolsModule.h"
 #include "UObject/SavePackage.h"
 #include "ObjectTools.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "Engine/Engine.h"
+#include "DataTableUtils.h"
+#include "XlsxWorkbookCache.h"
+#include "XlsxManager.h"
+#include "DataTableRowDecoder.h"
+#include "HAL/IConsoleManager.h"
 
-
+static TAutoConsoleVariable<bool> CVarConcurrentSave(
+    TEXT("DataTable.ConcurrentSave"),
+    false,
+    TEXT("Save the packages of a DataTable import batch with UPackage::SaveConcurrent instead of one after another"));
 
 bool DataTableAssetGanerator::CreateDataTableFromCSV(const FString& InAssetName, const FString& InCSVFilePath, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj)
 {
-    bool bExistFile = InCSVFilePath.IsEmpty() == false && FPaths::FileExists(InCSVFilePath);
-    bool bExistFolder = InAssetFolderPath.IsEmpty() == false && FPaths::DirectoryExists(InAssetFolderPath);
+    FDataTableImportData Data;
+    if (LoadForImport(InCSVFilePath, FString(), InAssetName, Data, nullptr, DataTableRowDecoderRegistry::Find(InStructObj.Get()) != nullptr) == false)
+    {
+        return false;
+    }
+
+    return CreateDataTable(InAssetName, Data, InAssetFolderPath, InStructObj);
+}
+
+bool DataTableAssetGanerator::LoadForImport(const FString& InCSVFilePath, const FString& InXlsxFilePath, const FString& InSheetName, FDataTableImportData& OutData, FString* OutError, bool InbRowDecoder)
+{
+    OutData.Source = FDataTableImportData::ESource::None;
+
+    if (InXlsxFilePath.IsEmpty() == false)
+    {
+        if (LoadSheetForImport(InXlsxFilePath, InSheetName, OutData.Sheet, OutError) == false)
+        {
+            return false;
+        }
+        OutData.Source = FDataTableImportData::ESource::Sheet;
+        return true;
+    }
+
+    // The sheet cache written with the CSV skips parsing the CSV text, a stale or unreadable one falls back to the CSV
+    FString SheetCachePath;
+    if (XlsxManager::FindSheetCache(InCSVFilePath, SheetCachePath) && LoadSheetCacheForImport(SheetCachePath, OutData.Cache))
+    {
+        OutData.Source = FDataTableImportData::ESource::SheetCache;
+        return true;
+    }
+
+    // A decoded struct never needs the text as an FString : the UTF-8 lines are split straight into a table
+    if (InbRowDecoder && LoadCSVTableForImport(InCSVFilePath, OutData.Sheet))
+    {
+        OutData.Source = FDataTableImportData::ESource::Sheet;
+        return true;
+    }
 
-    if (bExistFile == false || bExistFolder == false || InStructObj.IsValid() == false)
+    if (LoadCSVForImport(InCSVFilePath, OutData.CSVStr) == false)
     {
+        if (OutError != nullptr)
+        {
+            *OutError = TEXT("Failed to load CSV file");
+        }
         return false;
     }
+    OutData.Source = FDataTableImportData::ESource::CSV;
+    return true;
+}
 
-    FString AssetPath;
-    FPackageName::TryConvertFilenameToLongPackageName(InAssetFolderPath, AssetPath);
+bool DataTableAssetGanerator::CreateDataTable(const FString& InAssetName, const FDataTableImportData& InData, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj)
+{
+    UDataTable* NewDataTable = BuildDataTable(InAssetName, InData, InAssetFolderPath, InStructObj);
+    return NewDataTable != nullptr && SaveDataTables({ NewDataTable });
+}
+
+UDataTable* DataTableAssetGanerator::BuildDataTable(const FString& InAssetName, const FDataTableImportData& InData, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj, FDataTableUpdateStats* OutStats)
+{
+    if (InData.Source == FDataTableImportData::ESource::None)
+    {
+        return nullptr;
+    }
+
+    return BuildDataTableWith(InAssetName, InAssetFolderPath, InStructObj, [&InData](UDataTable* InDataTable, TArray<FString>& OutProblems, FDataTableUpdateStats& OutStats)
+    {
+        return FillDataTable(InDataTable, InData, OutProblems, &OutStats);
+    }, OutStats);
+}
+
+bool DataTableAssetGanerator::FillDataTable(UDataTable* InDataTable, const FDataTableImportData& InData, TArray<FString>& OutProblems, FDataTableUpdateStats* OutStats)
+{
+    switch (InData.Source)
+    {
+    case FDataTableImportData::ESource::CSV:
+        return FillDataTableFromCSVString(InDataTable, InData.CSVStr, OutProblems, OutStats);
+    case FDataTableImportData::ESource::Sheet:
+        return FillDataTableFromSheet(InDataTable, InData.Sheet, OutProblems, OutStats);
+    case FDataTableImportData::ESource::SheetCache:
+        return FillDataTableFromSheetCache(InDataTable, InData.Cache, OutProblems, OutStats);
+    default:
+        return false;
+    }
+}
+
+enum class ECSVEncoding : uint8
+{
+    UTF8,
+    UTF16LE,
+    UTF16BE,
+};
+
+// The file is read and decoded a chunk at a time, so the raw bytes never sit next to the whole string
+static constexpr int32 CSVReadChunkBytes = 64 * 1024;
+
+// UTF-8 unless a byte order mark says otherwise. Older conversions wrote UTF-16 : with a BOM, or little-endian without one,
+// which shows as ASCII commas, digits and line breaks followed by a zero byte
+static bool DetectCSVEncoding(const uint8* InHead, int32 InHeadSize, ECSVEncoding& OutEncoding, int32& OutBomSize)
+{
+    OutEncoding = ECSVEncoding::UTF8;
+    OutBomSize = 0;
+
+    if (InHeadSize >= 3 && InHead[0] == 0xEF && InHead[1] == 0xBB && InHead[2] == 0xBF)
+    {
+        OutBomSize = 3;
+        return true;
+    }
+    if (InHeadSize >= 2 && InHead[0] == 0xFF && InHead[1] == 0xFE)
+    {
+        OutEncoding = ECSVEncoding::UTF16LE;
+        OutBomSize = 2;
+        return true;
+    }
+    if (InHeadSize >= 2 && InHead[0] == 0xFE && InHead[1] == 0xFF)
+    {
+        OutEncoding = ECSVEncoding::UTF16BE;
+        OutBomSize = 2;
+        return true;
+    }
+
+    int32 EvenZeros = 0;
+    int32 OddZeros = 0;
+    for (int32 Index = 0; Index < InHeadSize; Index++)
+    {
+        if (InHead[Index] == 0)
+        {
+            (Index % 2 == 0 ? EvenZeros : OddZeros)++;
+        }
+    }
+
+    if (EvenZeros + OddZeros == 0)
+    {
+        return true;
+    }
+    if (OddZeros > EvenZeros)
+    {
+        OutEncoding = ECSVEncoding::UTF16LE;
+        return true;
+    }
+    return false;
+}
+
+// Bytes at the end of InData that start a character the chunk does not complete, kept for the next chunk
+static int32 GetIncompleteTailSize(const uint8* InData, int32 InSize, ECSVEncoding InEncoding)
+{
+    if (InEncoding != ECSVEncoding::UTF8)
+    {
+        // An odd byte, or a high surrogate whose pair is in the next chunk
+        int32 Tail = InSize % 2;
+        if (InSize - Tail >= 2)
+        {
+            const uint8* Last = InData + InSize - Tail - 2;
+            const uint16 Unit = InEncoding == ECSVEncoding::UTF16LE ? (Last[0] | (Last[1] << 8)) : ((Last[0] << 8) | Last[1]);
+            Tail += Unit >= 0xD800 && Unit <= 0xDBFF ? 2 : 0;
+        }
+        return Tail;
+    }
+
+    for (int32 Back = 1; Back <= FMath::Min(InSize, 4); Back++)
+    {
+        const uint8 Byte = InData[InSize - Back];
+        if ((Byte & 0xC0) == 0x80)
+        {
+            continue;
+        }
+
+        const int32 Length = Byte >= 0xF0 ? 4 : Byte >= 0xE0 ? 3 : Byte >= 0xC0 ? 2 : 1;
+        return Length > Back ? Back : 0;
+    }
+    return 0;
+}
+
+bool DataTableAssetGanerator::LoadCSVForImport(const FString& InCSVFilePath, FString& OutCSVStr)
+{
+    TUniquePtr<FArchive> Reader(InCSVFilePath.IsEmpty() ? nullptr : IFileManager::Get().CreateFileReader(*InCSVFilePath));
+    if (Reader.IsValid() == false)
+    {
+        return false;
+    }
+
+    const int64 FileSize = Reader->TotalSize();
+    if (FileSize > MAX_int32)
+    {
+        UE_LOG(LogTemp, Error, TEXT("%s is too large to import (%lld bytes)"), *InCSVFilePath, FileSize);
+        return false;
+    }
+
+    TArray<uint8> Buffer;
+    Buffer.SetNumUninitialized(CSVReadChunkBytes);
+
+    const int32 HeadSize = static_cast<int32>(FMath::Min<int64>(FileSize, 4096));
+    Reader->Serialize(Buffer.GetData(), HeadSize);
+
+    ECSVEncoding Encoding;
+    int32 BomSize;
+    if (DetectCSVEncoding(Buffer.GetData(), HeadSize, Encoding, BomSize) == false)
+    {
+        UE_LOG(LogTemp, Error, TEXT("%s is neither UTF-8 nor UTF-16, convert it again"), *InCSVFilePath);
+        return false;
+    }
+
+    Reader->Seek(BomSize);
+    OutCSVStr.Reset(static_cast<int32>(Encoding == ECSVEncoding::UTF8 ? FileSize - BomSize : (FileSize - BomSize) / 2));
+
+    // The type row is dropped after decoding, a byte offset could split a UTF-16 character
+    bool bInTypeRow = true;
+    auto AppendDecoded = [&OutCSVStr, &bInTypeRow](const TCHAR* InChars, int32 InLength)
+    {
+        if (bInTypeRow)
+        {
+            int32 TypeRowEnd = INDEX_NONE;
+            if (FStringView(InChars, InLength).FindChar(TEXT('\n'), TypeRowEnd) == false)
+            {
+                return;
+            }
+            InChars += TypeRowEnd + 1;
+            InLength -= TypeRowEnd + 1;
+            bInTypeRow = false;
+        }
+        OutCSVStr.AppendChars(InChars, InLength);
+    };
+
+    int32 Carried = 0;
+    int64 Remaining = FileSize - BomSize;
+    while (Remaining > 0)
+    {
+        const int32 ReadSize = static_cast<int32>(FMath::Min<int64>(Remaining, CSVReadChunkBytes - Carried));
+        Reader->Serialize(Buffer.GetData() + Carried, ReadSize);
+        if (Reader->IsError())
+        {
+            UE_LOG(LogTemp, Error, TEXT("Failed to read %s"), *InCSVFilePath);
+            return false;
+        }
+        Remaining -= ReadSize;
+
+        const int32 Available = Carried + ReadSize;
+        const int32 Tail = Remaining > 0 ? GetIncompleteTailSize(Buffer.GetData(), Available, Encoding) : 0;
+        const int32 Complete = Available - Tail;
+
+        if (Encoding == ECSVEncoding::UTF16BE)
+        {
+            for (int32 Index = 0; Index + 1 < Complete; Index += 2)
+            {
+                Swap(Buffer[Index], Buffer[Index + 1]);
+            }
+        }
+
+        if (Encoding == ECSVEncoding::UTF8)
+        {
+            const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Buffer.GetData()), Complete);
+            AppendDecoded(Converted.Get(), Converted.Length());
+        }
+        else
+        {
+            const auto Converted = StringCast<TCHAR>(reinterpret_cast<const UTF16CHAR*>(Buffer.GetData()), Complete / 2);
+            AppendDecoded(Converted.Get(), Converted.Length());
+        }
+
+        FMemory::Memmove(Buffer.GetData(), Buffer.GetData() + Complete, Tail);
+        Carried = Tail;
+    }
+
+    return true;
+}
+
+// One line the converter wrote, "<Key>,<cells>" with no quoting, added to OutTable as a row of InKind
+static void AddCSVLine(std::string_view InLine, ESheetRowKind InKind, std::vector<size_t>& InCellBegins, SheetTable& OutTable)
+{
+    SheetTableRow Row;
+    Row.Kind = InKind;
+    InCellBegins.clear();
+
+    const size_t KeyEnd = InLine.find(',');
+    Row.Key = InLine.substr(0, KeyEnd);
+    if (KeyEnd != std::string_view::npos)
+    {
+        Row.Text = InLine.substr(KeyEnd + 1);
+        InCellBegins.push_back(0);
+        for (size_t Index = 0; Index < Row.Text.size(); Index++)
+        {
+            if (Row.Text[Index] == ',')
+            {
+                InCellBegins.push_back(Index + 1);
+            }
+        }
+    }
+    Row.CellBegins = &InCellBegins;
+
+    OutTable.AddRow(Row);
+}
+
+bool DataTableAssetGanerator::LoadCSVTableForImport(const FString& InCSVFilePath, SheetTable& OutTable)
+{
+    OutTable.Reset();
+
+    TUniquePtr<FArchive> Reader(InCSVFilePath.IsEmpty() ? nullptr : IFileManager::Get().CreateFileReader(*InCSVFilePath));
+    if (Reader.IsValid() == false)
+    {
+        return false;
+    }
+
+    const int64 FileSize = Reader->TotalSize();
+    TArray<uint8> Buffer;
+    Buffer.SetNumUninitialized(CSVReadChunkBytes);
+
+    const int32 HeadSize = static_cast<int32>(FMath::Min<int64>(FileSize, 4096));
+    Reader->Serialize(Buffer.GetData(), HeadSize);
+
+    ECSVEncoding Encoding;
+    int32 BomSize;
+    if (DetectCSVEncoding(Buffer.GetData(), HeadSize, Encoding, BomSize) == false || Encoding != ECSVEncoding::UTF8)
+    {
+        return false;
+    }
+    Reader->Seek(BomSize);
+
+    // Complete lines are split out of each chunk, a line cut by the chunk end is carried to the next one.
+    // The converter never quotes a cell, a CSV holding quotes is left to the engine's parser.
+    std::vector<size_t> CellBegins;
+    ESheetRowKind Kind = ESheetRowKind::Types;
+    int32 Carried = 0;
+    int64 Remaining = FileSize - BomSize;
+    while (Remaining > 0 || Carried > 0)
+    {
+        const int32 ReadSize = static_cast<int32>(FMath::Min<int64>(Remaining, Buffer.Num() - Carried));
+        Reader->Serialize(Buffer.GetData() + Carried, ReadSize);
+        if (Reader->IsError())
+        {
+            OutTable.Reset();
+            return false;
+        }
+        Remaining -= ReadSize;
+
+        std::string_view Text(reinterpret_cast<const char*>(Buffer.GetData()), Carried + ReadSize);
+        if (Text.find('"', Carried) != std::string_view::npos)
+        {
+            OutTable.Reset();
+            return false;
+        }
+
+        while (Text.empty() == false)
+        {
+            const size_t LineEnd = Text.find('\n');
+            if (LineEnd == std::string_view::npos && Remaining > 0)
+            {
+                break;
+            }
+
+            std::string_view Line = Text.substr(0, LineEnd);
+            Text.remove_prefix(LineEnd == std::string_view::npos ? Text.size() : LineEnd + 1);
+
+            if (Line.empty() == false && Line.back() == '\r')
+            {
+                Line.remove_suffix(1);
+            }
+            if (Line.empty())
+            {
+                continue;
+            }
+
+            AddCSVLine(Line, Kind, CellBegins, OutTable);
+            Kind = Kind == ESheetRowKind::Types ? ESheetRowKind::Names : ESheetRowKind::Data;
+        }
+
+        // A single line longer than the buffer grows it instead of being split
+        Carried = static_cast<int32>(Text.size());
+        FMemory::Memmove(Buffer.GetData(), Text.data(), Carried);
+        if (Carried == Buffer.Num())
+        {
+            Buffer.SetNumUninitialized(Buffer.Num() * 2);
+        }
+    }
+
+    OutTable.ShrinkToFit();
+    if (OutTable.Names.empty())
+    {
+        OutTable.Reset();
+        return false;
+    }
+    return true;
+}
+
+bool DataTableAssetGanerator::CreateDataTableFromCSVString(const FString& InAssetName, const FString& InCSVStr, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj)
+{
+    UDataTable* NewDataTable = BuildDataTableWith(InAssetName, InAssetFolderPath, InStructObj, [&InCSVStr](UDataTable* InDataTable, TArray<FString>& OutProblems, FDataTableUpdateStats& OutStats)
+    {
+        return FillDataTableFromCSVString(InDataTable, InCSVStr, OutProblems, &OutStats);
+    });
+
+    return NewDataTable != nullptr && SaveDataTables({ NewDataTable });
+}
+
+bool DataTableAssetGanerator::LoadSheetForImport(const FString& InXlsxFilePath, const FString& InSheetName, SheetTable& OutTable, FString* OutError)
+{
+    XlsxWorkbookCache::FReaderPtr Reader = XlsxWorkbookCache::Acquire(InXlsxFilePath, OutError);
+    if (Reader.IsValid() == false)
+    {
+        return false;
+    }
+
+    SheetTableStats Stats;
+    std::string Error;
+    if (SheetTableReader::Load(*Reader, TCHAR_TO_UTF8(*InSheetName), OutTable, Stats, Error) == false)
+    {
+        if (OutError != nullptr)
+        {
+            *OutError = UTF8_TO_TCHAR(Error.c_str());
+        }
+        return false;
+    }
+
+    if (OutTable.Names.empty())
+    {
+        if (OutError != nullptr)
+        {
+            *OutError = TEXT("No header row with data types in sheet");
+        }
+        return false;
+    }
+
+    return true;
+}
+
+// Reuses OutString's allocation, cells are converted one at a time
+static void AssignUTF8(FString& OutString, std::string_view InText)
+{
+    FUTF8ToTCHAR Converted(InText.data(), static_cast<int32>(InText.size()));
+    OutString.Reset();
+    OutString.AppendChars(Converted.Get(), Converted.Length());
+}
+
+bool DataTableAssetGanerator::CreateDataTableFromSheet(const FString& InAssetName, const SheetTable& InTable, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj)
+{
+    UDataTable* NewDataTable = BuildDataTableWith(InAssetName, InAssetFolderPath, InStructObj, [&InTable](UDataTable* InDataTable, TArray<FString>& OutProblems, FDataTableUpdateStats& OutStats)
+    {
+        return FillDataTableFromSheet(InDataTable, InTable, OutProblems, &OutStats);
+    });
+
+    return NewDataTable != nullptr && SaveDataTables({ NewDataTable });
+}
+
+// Same column matching as the CSV importer : every cell column matches a property by name, unmatched columns are nullptr
+template<typename NameFuncType>
+static TArray<FProperty*> FindColumnProperties(UDataTable* InDataTable, size_t InColumnCount, NameFuncType&& InGetName, TArray<FString>& OutProblems)
+{
+    FString ColumnName;
+    TArray<FProperty*> ColumnProperties;
+    for (size_t Column = 0; Column < InColumnCount; Column++)
+    {
+        AssignUTF8(ColumnName, InGetName(Column));
+        FProperty* Property = InDataTable->FindTableProperty(FName(*ColumnName));
+        if (Property == nullptr)
+        {
+            OutProblems.Add(FString::Printf(TEXT("Cannot find Property for column '%s' in struct '%s'."), *ColumnName, *InDataTable->GetRowStruct()->GetName()));
+        }
+        ColumnProperties.Add(Property);
+    }
+    return ColumnProperties;
+}
+
+// Counts InRowData as added, changed or unchanged against the asset's row of the same name
+static void CompareRow(const UDataTable* InDataTable, const FName& InRowName, const uint8* InRowData, FDataTableUpdateStats& OutStats)
+{
+    const uint8* ExistingRow = InDataTable->FindRowUnchecked(InRowName);
+    if (ExistingRow == nullptr)
+    {
+        OutStats.AddedRows++;
+    }
+    else if (InDataTable->GetRowStruct()->CompareScriptStruct(ExistingRow, InRowData, PPF_None))
+    {
+        OutStats.UnchangedRows++;
+    }
+    else
+    {
+        OutStats.ChangedRows++;
+    }
+}
+
+// Transient table the imported rows are added to in sheet order, so the asset is replaced by FinishRowUpdate in one go
+static UDataTable* CreateStagingTable(UDataTable* InDataTable)
+{
+    UDataTable* StagingTable = NewObject<UDataTable>(GetTransientPackage(), NAME_None, RF_Transient);
+    StagingTable->RowStruct = InDataTable->RowStruct;
+    return StagingTable;
+}
+
+// Replaces the rows of InDataTable with those of InSourceTable, in InSourceTable's order, with one change notification
+static void RebuildRows(UDataTable* InDataTable, UDataTable* InSourceTable)
+{
+    InSourceTable->CopyImportOptions(InDataTable);
+    InDataTable->CreateTableFromOtherTable(InSourceTable);
+    InDataTable->HandleDataTableChanged();
+    InSourceTable->EmptyTable();
+}
+
+// Counts the rows of the asset that are no longer imported and replaces its rows with InStagingTable's, unless nothing changed.
+// InRowOrder holds the imported row names in sheet order, InSeenRows the same names.
+static void FinishRowUpdate(UDataTable* InDataTable, UDataTable* InStagingTable, const TArray<FName>& InRowOrder, const TSet<FName>& InSeenRows, FDataTableUpdateStats& OutStats)
+{
+    // The asset's rows are in sheet order unless a row was inserted or moved in the sheet, new rows at the end keep it
+    bool bInSheetOrder = true;
+    int32 RowIndex = 0;
+    for (const TPair<FName, uint8*>& Pair : InDataTable->GetRowMap())
+    {
+        if (InSeenRows.Contains(Pair.Key) == false)
+        {
+            OutStats.RemovedRows++;
+        }
+        else if (bInSheetOrder && InRowOrder[RowIndex++] != Pair.Key)
+        {
+            bInSheetOrder = false;
+        }
+    }
+
+    if (bInSheetOrder == false)
+    {
+        OutStats.ReorderedTables++;
+    }
+
+    if (OutStats.HasChanges() == false)
+    {
+        InStagingTable->EmptyTable();
+        return;
+    }
+
+    RebuildRows(InDataTable, InStagingTable);
+}
+
+// Updates InDataTable to the imported rows, calling InFillRow(Row, RowName, RowData) to set the properties of each initialized row
+template<typename KeyFuncType, typename FillRowFuncType>
+static void FillDataTableRows(UDataTable* InDataTable, size_t InRowCount, KeyFuncType&& InGetKey, FillRowFuncType&& InFillRow, TArray<FString>& OutProblems, FDataTableUpdateStats& OutStats)
+{
+    const UScriptStruct* RowStruct = InDataTable->GetRowStruct();
+    UDataTable* StagingTable = CreateStagingTable(InDataTable);
+    FString KeyStr;
+    TSet<FName> SeenRows;
+    SeenRows.Reserve(static_cast<int32>(InRowCount));
+    TArray<FName> RowOrder;
+    RowOrder.Reserve(static_cast<int32>(InRowCount));
+
+    // One scratch row, compared with the asset's row and copied into the staging table
+    uint8* RowData = static_cast<uint8*>(FMemory::Malloc(RowStruct->GetStructureSize(), RowStruct->GetMinAlignment()));
+
+    for (size_t Row = 0; Row < InRowCount; Row++)
+    {
+        AssignUTF8(KeyStr, InGetKey(Row));
+        const FName RowName = DataTableUtils::MakeValidName(KeyStr);
+        if (RowName.IsNone())
+        {
+            OutProblems.Add(FString::Printf(TEXT("Row '%llu' missing a name."), static_cast<uint64>(Row)));
+            continue;
+        }
+        bool bAlreadySeen = false;
+        SeenRows.Add(RowName, &bAlreadySeen);
+        if (bAlreadySeen)
+        {
+            OutProblems.Add(FString::Printf(TEXT("Duplicate row name '%s'."), *RowName.ToString()));
+            continue;
+        }
+        RowOrder.Add(RowName);
+
+        RowStruct->InitializeStruct(RowData);
+        InFillRow(Row, RowName, RowData);
+
+        FTableRowBase* TableRow = reinterpret_cast<FTableRowBase*>(RowData);
+        TableRow->OnPostDataImport(InDataTable, RowName, OutProblems);
+        CompareRow(InDataTable, RowName, RowData, OutStats);
+        StagingTable->AddRow(RowName, *reinterpret_cast<const FTableRowBase*>(RowData));
+
+        RowStruct->DestroyStruct(RowData);
+    }
+
+    FMemory::Free(RowData);
+
+    FinishRowUpdate(InDataTable, StagingTable, RowOrder, SeenRows, OutStats);
+}
+
+static void AssignCellText(const FString& InCellStr, FProperty* InProperty, uint8* InRowData, const FName& InRowName, TArray<FString>& OutProblems)
+{
+    const FString Error = DataTableUtils::AssignStringToProperty(InCellStr, InProperty, InRowData);
+    if (Error.IsEmpty() == false)
+    {
+        OutProblems.Add(FString::Printf(TEXT("Problem assigning string '%s' to property '%s' on row '%s' : %s"),
+            *InCellStr, *InProperty->GetName(), *InRowName.ToString(), *Error));
+    }
+}
+
+// Decoder field of each column's property, INDEX_NONE where the column is imported through reflection
+static TArray<int32> FindDecoderFields(const FDataTableRowDecoder* InDecoder, const TArray<FProperty*>& InColumnProperties)
+{
+    TArray<int32> DecoderFields;
+    DecoderFields.Init(INDEX_NONE, InColumnProperties.Num());
+    for (int32 Column = 0; InDecoder != nullptr && Column < InColumnProperties.Num(); Column++)
+    {
+        if (InColumnProperties[Column] != nullptr)
+        {
+            DecoderFields[Column] = InDecoder->FindField(InColumnProperties[Column]->GetFName());
+        }
+    }
+    return DecoderFields;
+}
+
+// The generated decoder parses the cell in place when it can, anything it leaves goes through the property's text import
+static void ImportCell(const FDataTableRowDecoder* InDecoder, int32 InDecoderField, std::string_view InText, FProperty* InProperty,
+    uint8* InRowData, const FName& InRowName, FString& OutCellStr, TArray<FString>& OutProblems)
+{
+    if (InDecoderField != INDEX_NONE && InDecoder->DecodeCell(InDecoderField, InText, InRowData))
+    {
+        return;
+    }
+
+    AssignUTF8(OutCellStr, InText);
+    AssignCellText(OutCellStr, InProperty, InRowData, InRowName, OutProblems);
+}
+
+bool DataTableAssetGanerator::FillDataTableFromCSVString(UDataTable* InDataTable, const FString& InCSVStr, TArray<FString>& OutProblems, FDataTableUpdateStats* OutStats)
+{
+    if (InDataTable->GetRowStruct() == nullptr)
+    {
+        OutProblems.Add(TEXT("No RowStruct specified."));
+        return false;
+    }
+
+    // The engine's CSV import always rebuilds its table : the transient one it parses into is the staging table
+    UDataTable* ParsedTable = CreateStagingTable(InDataTable);
+    OutProblems = ParsedTable->CreateTableFromCSVString(InCSVStr);
+
+    FDataTableUpdateStats Stats;
+    TSet<FName> SeenRows;
+    SeenRows.Reserve(ParsedTable->GetRowMap().Num());
+    TArray<FName> RowOrder;
+    RowOrder.Reserve(ParsedTable->GetRowMap().Num());
+    for (const TPair<FName, uint8*>& Pair : ParsedTable->GetRowMap())
+    {
+        SeenRows.Add(Pair.Key);
+        RowOrder.Add(Pair.Key);
+        CompareRow(InDataTable, Pair.Key, Pair.Value, Stats);
+    }
+    FinishRowUpdate(InDataTable, ParsedTable, RowOrder, SeenRows, Stats);
+
+    if (OutStats != nullptr)
+    {
+        *OutStats = Stats;
+    }
+    return true;
+}
+
+bool DataTableAssetGanerator::FillDataTableFromSheet(UDataTable* InDataTable, const SheetTable& InTable, TArray<FString>& OutProblems, FDataTableUpdateStats* OutStats)
+{
+    if (InDataTable->GetRowStruct() == nullptr)
+    {
+        OutProblems.Add(TEXT("No RowStruct specified."));
+        return false;
+    }
+
+    // The key is the row name, Names holds the cell columns only
+    const TArray<FProperty*> ColumnProperties = FindColumnProperties(InDataTable, InTable.Names.size(),
+        [&InTable](size_t InColumn) { return std::string_view(InTable.Names[InColumn]); }, OutProblems);
+
+    const FDataTableRowDecoder* Decoder = DataTableRowDecoderRegistry::Find(InDataTable->GetRowStruct());
+    const TArray<int32> DecoderFields = FindDecoderFields(Decoder, ColumnProperties);
+
+    FString CellStr;
+    FDataTableUpdateStats Stats;
+    FillDataTableRows(InDataTable, InTable.GetRowCount(), [&InTable](size_t InRow) { return InTable.GetKey(InRow); },
+        [&](size_t InRow, const FName& InRowName, uint8* InRowData)
+    {
+        const int32 CellCount = FMath::Min(static_cast<int32>(InTable.GetCellCount(InRow)), ColumnProperties.Num());
+        for (int32 Column = 0; Column < CellCount; Column++)
+        {
+            if (ColumnProperties[Column] != nullptr)
+            {
+                ImportCell(Decoder, DecoderFields[Column], InTable.GetCell(InRow, Column), ColumnProperties[Column], InRowData, InRowName, CellStr, OutProblems);
+            }
+        }
+    }, OutProblems, Stats);
+
+    if (OutStats != nullptr)
+    {
+        *OutStats = Stats;
+    }
+    return true;
+}
 
-    FString CSVStr;
-    FFileHelper::LoadFileToString(CSVStr, *InCSVFilePath);
+bool DataTableAssetGanerator::LoadSheetCacheForImport(const FString& InSheetCachePath, SheetCache& OutCache, FString* OutError)
+{
+    std::string Error;
+    if (OutCache.Open(std::filesystem::path(*InSheetCachePath), Error) == false)
+    {
+        if (OutError != nullptr)
+        {
+            *OutError = UTF8_TO_TCHAR(Error.c_str());
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool DataTableAssetGanerator::CreateDataTableFromSheetCache(const FString& InAssetName, const SheetCache& InCache, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj)
+{
+    UDataTable* NewDataTable = BuildDataTableWith(InAssetName, InAssetFolderPath, InStructObj, [&InCache](UDataTable* InDataTable, TArray<FString>& OutProblems, FDataTableUpdateStats& OutStats)
+    {
+        return FillDataTableFromSheetCache(InDataTable, InCache, OutProblems, &OutStats);
+    });
+
+    return NewDataTable != nullptr && SaveDataTables({ NewDataTable });
+}
 
-    TArray<FString> Lines;
-    CSVStr.ParseIntoArrayLines(Lines, true);
-    if (Lines.IsValidIndex(0))
+bool DataTableAssetGanerator::FillDataTableFromSheetCache(UDataTable* InDataTable, const SheetCache& InCache, TArray<FString>& OutProblems, FDataTableUpdateStats* OutStats)
+{
+    if (InDataTable->GetRowStruct() == nullptr)
     {
-        Lines.RemoveAt(0);
-        CSVStr = FString::Join(Lines, TEXT("\n"));
+        OutProblems.Add(TEXT("No RowStruct specified."));
+        return false;
     }
 
+    const size_t ColumnCount = InCache.GetColumnCount();
+    const TArray<FProperty*> ColumnProperties = FindColumnProperties(InDataTable, ColumnCount,
+        [&InCache](size_t InColumn) { return InCache.GetColumnName(InColumn); }, OutProblems);
+
+    // Numeric cells go straight into plain numeric properties, everything else is imported from its text like the CSV
+    TArray<FNumericProperty*> NumericProperties;
+    for (size_t Column = 0; Column < ColumnCount; Column++)
+    {
+        FNumericProperty* NumericProperty = CastField<FNumericProperty>(ColumnProperties[Column]);
+        const bool bDirect = NumericProperty != nullptr && NumericProperty->ArrayDim == 1 && NumericProperty->IsEnum() == false
+            && InCache.GetColumnStorage(Column) != ESheetCacheStorage::String
+            && (NumericProperty->IsFloatingPoint() || InCache.GetColumnStorage(Column) == ESheetCacheStorage::Int);
+        NumericProperties.Add(bDirect ? NumericProperty : nullptr);
+    }
+
+    // Text columns go through the generated decoder when the struct has one
+    const FDataTableRowDecoder* Decoder = DataTableRowDecoderRegistry::Find(InDataTable->GetRowStruct());
+    const TArray<int32> DecoderFields = FindDecoderFields(Decoder, ColumnProperties);
+
+    std::string CellText;
+    FString CellStr;
+    FDataTableUpdateStats Stats;
+    FillDataTableRows(InDataTable, InCache.GetRowCount(), [&InCache](size_t InRow) { return InCache.GetKey(InRow); },
+        [&](size_t InRow, const FName& InRowName, uint8* InRowData)
+    {
+        for (size_t Column = 0; Column < ColumnCount; Column++)
+        {
+            if (FNumericProperty* NumericProperty = NumericProperties[Column])
+            {
+                void* Value = NumericProperty->ContainerPtrToValuePtr<void>(InRowData);
+                if (InCache.GetColumnStorage(Column) == ESheetCacheStorage::Real)
+                {
+                    NumericProperty->SetFloatingPointPropertyValue(Value, InCache.GetReal(InRow, Column));
+                }
+                else if (NumericProperty->IsFloatingPoint())
+                {
+                    NumericProperty->SetFloatingPointPropertyValue(Value, static_cast<double>(InCache.GetInt(InRow, Column)));
+                }
+                else
+                {
+                    NumericProperty->SetIntPropertyValue(Value, InCache.GetInt(InRow, Column));
+                }
+            }
+            else if (ColumnProperties[Column] != nullptr)
+            {
+                CellText.clear();
+                InCache.AppendText(InRow, Column, CellText);
+                ImportCell(Decoder, DecoderFields[static_cast<int32>(Column)], CellText, ColumnProperties[Column], InRowData, InRowName, CellStr, OutProblems);
+            }
+        }
+    }, OutProblems, Stats);
+
+    if (OutStats != nullptr)
+    {
+        *OutStats = Stats;
+    }
+    return true;
+}
+
+UDataTable* DataTableAssetGanerator::FindOrCreateDataTable(const FString& InAssetName, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj)
+{
+    bool bExistFolder = InAssetFolderPath.IsEmpty() == false && FPaths::DirectoryExists(InAssetFolderPath);
+
+    if (bExistFolder == false || InStructObj.IsValid() == false)
+    {
+        return nullptr;
+    }
+
+    FString AssetPath;
+    FPackageName::TryConvertFilenameToLongPackageName(InAssetFolderPath, AssetPath);
+
     FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
 
     UDataTableFactory* DataTableFactory = NewObject<UDataTableFactory>();
@@ -50,33 +824,130 @@ bool DataTableAssetGanerator::CreateDataTableFromCSV(const FString& InAssetName,
         DataTableAsset = AssetToolsModule.Get().CreateAsset(AssetName, FPaths::GetPath(PackageName), UDataTable::StaticClass(), DataTableFactory);
     }
 
-    if (IsValid(DataTableAsset))
+    UDataTable* NewDataTable = Cast<UDataTable>(DataTableAsset);
+    return IsValid(NewDataTable) ? NewDataTable : nullptr;
+}
+
+UDataTable* DataTableAssetGanerator::BuildDataTableWith(const FString& InAssetName, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj,
+    TFunctionRef<bool(UDataTable*, TArray<FString>&, FDataTableUpdateStats&)> InFill, FDataTableUpdateStats* OutStats)
+{
+    check(IsInGameThread());
+
+    UDataTable* NewDataTable = FindOrCreateDataTable(InAssetName, InAssetFolderPath, InStructObj);
+    if (NewDataTable == nullptr)
     {
-        UDataTable* NewDataTable = Cast<UDataTable>(DataTableAsset);
-        if (IsValid(NewDataTable))
+        return nullptr;
+    }
+
+    TArray<FString> Problems;
+    FDataTableUpdateStats Stats;
+    const bool bFilled = InFill(NewDataTable, Problems, Stats);
+
+    for (const FString& Problem : Problems)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Problem importing DataTable '%s' : %s"), *NewDataTable->GetName(), *Problem);
+    }
+
+    if (bFilled == false)
+    {
+        return nullptr;
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("DataTable '%s' : %d rows added, %d changed, %d removed, %d unchanged%s"),
+        *NewDataTable->GetName(), Stats.AddedRows, Stats.ChangedRows, Stats.RemovedRows, Stats.UnchangedRows, Stats.ReorderedTables > 0 ? TEXT(", reordered") : TEXT(""));
+
+    // An unchanged table keeps its package clean, so SaveDataTables leaves it alone
+    if (Stats.HasChanges())
+    {
+        NewDataTable->MarkPackageDirty();
+    }
+
+    if (OutStats != nullptr)
+    {
+        *OutStats = Stats;
+    }
+    return NewDataTable;
+}
+
+bool DataTableAssetGanerator::SaveDataTables(const TArray<UDataTable*>& InDataTables, TArray<UDataTable*>* OutFailedTables)
+{
+    check(IsInGameThread());
+
+    if (InDataTables.Num() == 0)
+    {
+        return true;
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    FSavePackageArgs SaveArgs;
+    SaveArgs.TopLevelFlags = EObjectFlags::RF_Public | EObjectFlags::RF_Standalone;
+
+    TArray<UDataTable*> SavedTables;
+    TArray<FPackageSaveInfo> SaveInfos;
+    TArray<FString> PackageFileNames;
+    for (UDataTable* DataTable : InDataTables)
+    {
+        // Clean packages are already on disk as they are : new assets start dirty and imports only dirty tables they changed
+        if (DataTable->GetOutermost()->IsDirty() == false)
         {
-            TArray<FString> Problems = NewDataTable->CreateTableFromCSVString(CSVStr);
-            if (Problems.Num() > 0)
-            {
-                for (const FString& Problem : Problems)
-                {
-                    UE_LOG(LogTemp, Error, TEXT("Problem importing DataTable '%s' : %s"), *DataTableAsset->GetName(), *Problem);
-                }
-            }
+            continue;
         }
 
-        FAssetRegistryModule::AssetCreated(DataTableAsset);
-        DataTableAsset->MarkPackageDirty();
+        SavedTables.Add(DataTable);
+        FPackageSaveInfo& SaveInfo = SaveInfos.AddDefaulted_GetRef();
+        SaveInfo.Package = DataTable->GetOutermost();
+        SaveInfo.Asset = DataTable;
+        SaveInfo.Filename = FPackageName::LongPackageNameToFilename(SaveInfo.Package->GetName(), FPackageName::GetAssetPackageExtension());
+        PackageFileNames.Add(SaveInfo.Filename);
+    }
 
-        UPackage* Package = DataTableAsset->GetOutermost();
-        FString PackageFileName = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
-        FSavePackageArgs SaveArgs;
-        SaveArgs.TopLevelFlags = EObjectFlags::RF_Public | EObjectFlags::RF_Standalone;
+    TArray<bool> Saved;
+    Saved.Init(false, SaveInfos.Num());
+    if (CVarConcurrentSave.GetValueOnGameThread() && SaveInfos.Num() > 1)
+    {
+        TArray<FSavePackageResultStruct> Results;
+        UPackage::SaveConcurrent(SaveInfos, SaveArgs, Results);
+        for (int32 Index = 0; Index < Results.Num() && Index < Saved.Num(); Index++)
+        {
+            Saved[Index] = Results[Index].IsSuccessful();
+        }
+    }
+    else
+    {
+        for (int32 Index = 0; Index < SaveInfos.Num(); Index++)
+        {
+            Saved[Index] = UPackage::SavePackage(SaveInfos[Index].Package, SaveInfos[Index].Asset, *SaveInfos[Index].Filename, SaveArgs);
+        }
+    }
 
-        return UPackage::SavePackage(Package, nullptr, *PackageFileName, SaveArgs);
+    // New assets were already announced by AssetTools, one scan picks up every saved file instead of a notification per table
+    if (PackageFileNames.Num() > 0)
+    {
+        FAssetRegistryModule& AssetRegistryModule = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry");
+        AssetRegistryModule.Get().ScanModifiedAssetFiles(PackageFileNames);
     }
 
-    return false;
+    bool bAllSaved = true;
+    for (int32 Index = 0; Index < Saved.Num(); Index++)
+    {
+        if (Saved[Index] == false)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Failed to save DataTable package %s"), *SaveInfos[Index].Filename);
+            bAllSaved = false;
+            if (OutFailedTables != nullptr)
+            {
+                OutFailedTables->Add(SavedTables[Index]);
+            }
+        }
+    }
+
+    if (InDataTables.Num() > 1)
+    {
+        UE_LOG(LogTemp, Display, TEXT("Saved %d DataTable packages in %.3f sec, %d unchanged"), SavedTables.Num(), FPlatformTime::Seconds() - StartTime, InDataTables.Num() - SavedTables.Num());
+    }
+
+    return bAllSaved;
 }
 
 DataTableAssetGanerator::DataTableAssetGanerator()
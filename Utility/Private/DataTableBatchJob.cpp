@@ -0,0 +1,356 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DataTableBatchJob.h"
+#include "XlsxManager.h"
+#include "XlsxWorkbookCache.h"
+#include "StructGenerator.h"
+#include "DataTableAssetGenerator.h"
+#include "DataTableRowDecoder.h"
+#include "Engine/DataTable.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Tasks/Task.h"
+
+// Game thread time spent creating DataTable assets per tick
+static constexpr double ImportTickBudgetSeconds = 0.010;
+
+static int32 GetBatchWorkerCount(int32 InItemCount)
+{
+    return FMath::Clamp(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1, FMath::Max(1, InItemCount));
+}
+
+DataTableBatchJob::DataTableBatchJob(EBatchJobType InType, int32 InTotalCount, FOnBatchJobProgress InOnProgress, FOnBatchJobCompleted InOnCompleted)
+    : Type(InType)
+    , TotalCount(InTotalCount)
+    , StartTime(FPlatformTime::Seconds())
+    , bCancelRequested(false)
+    , bFinished(false)
+    , CompletedCount(0)
+    , bLoadFinished(false)
+    , OnProgress(MoveTemp(InOnProgress))
+    , OnCompleted(MoveTemp(InOnCompleted))
+{
+    Summary.Type = InType;
+}
+
+DataTableBatchJob::~DataTableBatchJob()
+{
+    if (ImportTickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(ImportTickerHandle);
+    }
+}
+
+TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> DataTableBatchJob::ConvertCSV(const TMap<FString, TArray<FString>>& InSheetMap, const FString& InCSVFolderPath, bool InbForceRebuild, bool InbWriteSheetCache, FOnBatchJobProgress InOnProgress, FOnBatchJobCompleted InOnCompleted)
+{
+    int32 SheetCount = 0;
+    TArray<TPair<FString, TArray<FString>>> Workbooks;
+    for (const TPair<FString, TArray<FString>>& Pair : InSheetMap)
+    {
+        SheetCount += Pair.Value.Num();
+        Workbooks.Add(Pair);
+    }
+
+    TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> Job = MakeShareable(new DataTableBatchJob(EBatchJobType::ConvertCSV, SheetCount, MoveTemp(InOnProgress), MoveTemp(InOnCompleted)));
+
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [Job, Workbooks = MoveTemp(Workbooks), SheetCount, InCSVFolderPath, InbForceRebuild, InbWriteSheetCache]()
+    {
+        // Workbooks are spread over the workers like the build commandlet does, each workbook splits its share among
+        // its sheets; many single-sheet workbooks then convert side by side instead of one sheet at a time
+        const int32 WorkerCount = GetBatchWorkerCount(SheetCount);
+        const int32 WorkbookWorkers = FMath::Clamp(WorkerCount, 1, FMath::Max(Workbooks.Num(), 1));
+        std::atomic<int32> NextWorkbook(0);
+
+        ParallelFor(WorkbookWorkers, [&](int32)
+        {
+            for (int32 Index = NextWorkbook++; Index < Workbooks.Num(); Index = NextWorkbook++)
+            {
+                if (Job->IsCancelled())
+                {
+                    return;
+                }
+
+                const TPair<FString, TArray<FString>>& Pair = Workbooks[Index];
+                const FString ExcelName = FPaths::GetCleanFilename(Pair.Key);
+
+                // Sheets of one workbook share a single reader and are converted in parallel
+                FXlsxConvertOptions ConvertOptions;
+                ConvertOptions.MaxWorkers = FMath::Max(WorkerCount / WorkbookWorkers, 1);
+                ConvertOptions.CancelFlag = &Job->bCancelRequested;
+                ConvertOptions.bForceRebuild = InbForceRebuild;
+                ConvertOptions.bWriteSheetCache = InbWriteSheetCache;
+                ConvertOptions.OnSheetCompleted = [&Job, &ExcelName](const FSheetConvertResult& InResult)
+                {
+                    FBatchJobProgress Progress;
+                    Progress.ExcelName = ExcelName;
+                    Progress.SheetName = InResult.SheetName;
+                    Progress.bSuccess = InResult.bSuccess;
+                    Progress.bUpToDate = InResult.bUpToDate;
+                    Progress.Error = InResult.Error;
+                    Job->ReportProgress(MoveTemp(Progress));
+                };
+
+                TArray<FSheetConvertResult> Results;
+                if (XlsxManager::ConvertSpecificSheet(Pair.Key, Pair.Value, InCSVFolderPath, ConvertOptions, &Results) == false && Results.Num() == 0)
+                {
+                    // The workbook itself could not be opened, none of its sheets were reported
+                    FScopeLock Lock(&Job->SummaryLock);
+                    Job->Summary.Failures.Add(ExcelName);
+                }
+            }
+        });
+
+        Job->Complete();
+    });
+
+    return Job;
+}
+
+TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> DataTableBatchJob::GenerateStruct(const TArray<FString>& InExcelFiles, const FString& InCSVFolderPath, const FString& InStructFolderPath, bool InbHeaderPerSheet, FOnBatchJobProgress InOnProgress, FOnBatchJobCompleted InOnCompleted)
+{
+    TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> Job = MakeShareable(new DataTableBatchJob(EBatchJobType::GenerateStruct, InExcelFiles.Num(), MoveTemp(InOnProgress), MoveTemp(InOnCompleted)));
+
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [Job, ExcelFiles = InExcelFiles, InCSVFolderPath, InStructFolderPath, InbHeaderPerSheet]()
+    {
+        // Schemas are read in parallel; StructGenerator serializes the writes into the shared struct folder and
+        // fails a workbook whose header would replace one generated for another workbook
+        const int32 WorkerCount = GetBatchWorkerCount(ExcelFiles.Num());
+        std::atomic<int32> NextFile(0);
+
+        ParallelFor(WorkerCount, [&](int32)
+        {
+            for (int32 Index = NextFile++; Index < ExcelFiles.Num(); Index = NextFile++)
+            {
+                if (Job->IsCancelled())
+                {
+                    return;
+                }
+
+                FBatchJobProgress Progress;
+                Progress.ExcelName = FPaths::GetCleanFilename(ExcelFiles[Index]);
+                FStructGenerateOptions StructOptions;
+                StructOptions.bHeaderPerSheet = InbHeaderPerSheet;
+                FStructGenerateStats StructStats;
+
+                Progress.bSuccess = StructGenerator::GenerateStructFromXlsx(ExcelFiles[Index], InCSVFolderPath, InStructFolderPath, StructOptions, &StructStats);
+                if (Progress.bSuccess == false)
+                {
+                    Progress.Error = TEXT("Generate Struct Failed");
+                }
+
+                // Nothing written means nothing for UHT or the compiler to rebuild
+                Progress.bUpToDate = Progress.bSuccess && StructStats.HasChanges() == false;
+
+                Job->ReportProgress(MoveTemp(Progress));
+            }
+        });
+
+        Job->Complete();
+    });
+
+    return Job;
+}
+
+TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> DataTableBatchJob::ImportDataTable(const TArray<FDataTableImportItem>& InItems, const FString& InAssetFolderPath, FOnBatchJobProgress InOnProgress, FOnBatchJobCompleted InOnCompleted)
+{
+    check(IsInGameThread());
+
+    TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> Job = MakeShareable(new DataTableBatchJob(EBatchJobType::ImportDataTable, InItems.Num(), MoveTemp(InOnProgress), MoveTemp(InOnCompleted)));
+    Job->RunImport(InItems, InAssetFolderPath);
+
+    return Job;
+}
+
+void DataTableBatchJob::RunImport(const TArray<FDataTableImportItem>& InItems, const FString& InAssetFolderPath)
+{
+    AssetFolderPath = InAssetFolderPath;
+    ImportTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &DataTableBatchJob::TickImport));
+
+    // Row structs are only looked at here on the game thread, the workers get whether each one has a decoder
+    TArray<bool> RowDecoders;
+    for (const FDataTableImportItem& Item : InItems)
+    {
+        RowDecoders.Add(DataTableRowDecoderRegistry::Find(Item.StructObj.Get()) != nullptr);
+    }
+
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [Job = AsShared(), Items = InItems, RowDecoders = MoveTemp(RowDecoders)]()
+    {
+        const int32 WorkerCount = GetBatchWorkerCount(Items.Num());
+        std::atomic<int32> NextItem(0);
+
+        ParallelFor(WorkerCount, [&](int32)
+        {
+            for (int32 Index = NextItem++; Index < Items.Num(); Index = NextItem++)
+            {
+                if (Job->IsCancelled())
+                {
+                    return;
+                }
+
+                TSharedPtr<FLoadedTable> Loaded = MakeShared<FLoadedTable>();
+                Loaded->Item = Items[Index];
+                Loaded->bLoaded = DataTableAssetGanerator::LoadForImport(Items[Index].CSVFilePath, Items[Index].ExcelFilePath, Items[Index].AssetName, Loaded->Data, &Loaded->Error, RowDecoders[Index]);
+                Job->LoadedTables.Enqueue(MoveTemp(Loaded));
+            }
+        });
+
+        Job->bLoadFinished = true;
+    });
+}
+
+bool DataTableBatchJob::TickImport(float InDeltaTime)
+{
+    const double TickStart = FPlatformTime::Seconds();
+
+    TSharedPtr<FLoadedTable> Loaded;
+    while (IsCancelled() == false && LoadedTables.Dequeue(Loaded))
+    {
+        FBatchJobProgress Progress;
+        Progress.SheetName = Loaded->Item.AssetName;
+        Progress.ExcelName = FPaths::GetCleanFilename(Loaded->Item.ExcelFilePath);
+        if (Loaded->bLoaded)
+        {
+            // Packages are saved together at the end, see SaveBuiltTables
+            const double BuildStart = FPlatformTime::Seconds();
+            FDataTableUpdateStats RowStats;
+            UDataTable* DataTable = DataTableAssetGanerator::BuildDataTable(Loaded->Item.AssetName, Loaded->Data, AssetFolderPath, Loaded->Item.StructObj, &RowStats);
+            {
+                FScopeLock Lock(&SummaryLock);
+                Summary.BuildSeconds += FPlatformTime::Seconds() - BuildStart;
+                Summary.RowStats += RowStats;
+            }
+
+            Progress.bSuccess = DataTable != nullptr;
+            Progress.bUpToDate = Progress.bSuccess && RowStats.HasChanges() == false;
+            if (Progress.bSuccess)
+            {
+                BuiltTables.Add({ DataTable, Progress.ExcelName, Progress.SheetName });
+            }
+        }
+        if (Progress.bSuccess == false)
+        {
+            Progress.Error = Loaded->bLoaded ? TEXT("Create Data Table Failed") : Loaded->Error;
+        }
+
+        ReportProgress(MoveTemp(Progress));
+
+        if (FPlatformTime::Seconds() - TickStart > ImportTickBudgetSeconds)
+        {
+            return true;
+        }
+    }
+
+    // Read the flag before the queue, a table enqueued after an empty check would otherwise be dropped
+    const bool bLoaderDone = bLoadFinished.load();
+    if (bLoaderDone && (IsCancelled() || LoadedTables.IsEmpty()))
+    {
+        // Tables built before a cancel are saved too, like work already started in the other jobs
+        SaveBuiltTables();
+
+        ImportTickerHandle.Reset();
+        Complete();
+        return false;
+    }
+
+    return true;
+}
+
+void DataTableBatchJob::SaveBuiltTables()
+{
+    const double SaveStart = FPlatformTime::Seconds();
+
+    TArray<UDataTable*> DataTables;
+    for (const FBuiltTable& Built : BuiltTables)
+    {
+        if (UDataTable* DataTable = Built.DataTable.Get())
+        {
+            DataTables.Add(DataTable);
+        }
+    }
+
+    TArray<UDataTable*> FailedTables;
+    DataTableAssetGanerator::SaveDataTables(DataTables, &FailedTables);
+
+    FScopeLock Lock(&SummaryLock);
+    Summary.SaveSeconds = FPlatformTime::Seconds() - SaveStart;
+
+    // Reported as succeeded when built, a failed save turns them into failures
+    for (const FBuiltTable& Built : BuiltTables)
+    {
+        if (Built.DataTable.IsValid() == false || FailedTables.Contains(Built.DataTable.Get()))
+        {
+            --Summary.SucceededCount;
+            Summary.Failures.Add(FString::Printf(TEXT("%s / %s : Save Data Table Failed"), *Built.ExcelName, *Built.SheetName));
+        }
+    }
+
+    BuiltTables.Empty();
+}
+
+void DataTableBatchJob::Cancel()
+{
+    bCancelRequested = true;
+}
+
+void DataTableBatchJob::ReportProgress(FBatchJobProgress InProgress)
+{
+    InProgress.CompletedCount = ++CompletedCount;
+    InProgress.TotalCount = TotalCount;
+
+    {
+        FScopeLock Lock(&SummaryLock);
+        if (InProgress.bSuccess)
+        {
+            ++Summary.SucceededCount;
+            Summary.UpToDateCount += InProgress.bUpToDate ? 1 : 0;
+        }
+        else if (IsCancelled() == false)
+        {
+            // Sheets skipped by a cancel are not failures
+            Summary.Failures.Add(InProgress.SheetName.IsEmpty()
+                ? FString::Printf(TEXT("%s : %s"), *InProgress.ExcelName, *InProgress.Error)
+                : FString::Printf(TEXT("%s / %s : %s"), *InProgress.ExcelName, *InProgress.SheetName, *InProgress.Error));
+        }
+    }
+
+    TWeakPtr<DataTableBatchJob, ESPMode::ThreadSafe> WeakJob = AsShared();
+    AsyncTask(ENamedThreads::GameThread, [WeakJob, Progress = MoveTemp(InProgress)]()
+    {
+        if (TSharedPtr<DataTableBatchJob, ESPMode::ThreadSafe> Job = WeakJob.Pin())
+        {
+            Job->OnProgress.ExecuteIfBound(Progress);
+        }
+    });
+}
+
+void DataTableBatchJob::Complete()
+{
+    if (bFinished.exchange(true))
+    {
+        return;
+    }
+
+    FBatchJobSummary Result;
+    {
+        FScopeLock Lock(&SummaryLock);
+        Summary.bCancelled = IsCancelled();
+        Summary.Seconds = FPlatformTime::Seconds() - StartTime;
+        Result = Summary;
+    }
+
+    const FXlsxWorkbookCacheStats CacheStats = XlsxWorkbookCache::GetStats();
+    UE_LOG(LogTemp, Log, TEXT("DataTable batch finished : %d succeeded, %d failed in %.3f sec%s (workbook cache %lld hits, %lld misses)"),
+        Result.SucceededCount, Result.Failures.Num(), Result.Seconds, Result.bCancelled ? TEXT(" (cancelled)") : TEXT(""), CacheStats.Hits, CacheStats.Misses);
+    if (Result.Type == EBatchJobType::ImportDataTable)
+    {
+        UE_LOG(LogTemp, Log, TEXT("DataTable import : %.3f sec building tables, %.3f sec saving packages, %d rows added, %d changed, %d removed, %d unchanged, %d tables reordered"),
+            Result.BuildSeconds, Result.SaveSeconds, Result.RowStats.AddedRows, Result.RowStats.ChangedRows, Result.RowStats.RemovedRows, Result.RowStats.UnchangedRows, Result.RowStats.ReorderedTables);
+    }
+
+    // Keeps the job alive until the owner has seen the result, queued behind any pending progress
+    AsyncTask(ENamedThreads::GameThread, [Job = AsShared(), Result = MoveTemp(Result)]()
+    {
+        Job->OnCompleted.ExecuteIfBound(Result);
+    });
+}
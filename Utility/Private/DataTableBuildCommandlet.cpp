@@ -0,0 +1,375 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DataTableBuildCommandlet.h"
+#include "DataTableManagerConfig.h"
+#include "XlsxManager.h"
+#include "StructGenerator.h"
+#include "DataTableAssetGenerator.h"
+#include "DataTableRowDecoder.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Engine/DataTable.h"
+#include "HAL/FileManager.h"
+#include "Misc/PackageName.h"
+#include "RowStructIndex.h"
+
+#include <atomic>
+
+namespace
+{
+    struct FBuildStageResult
+    {
+        const TCHAR* Name = TEXT("");
+        bool bRan = false;
+        int32 SucceededCount = 0;
+        // Included in SucceededCount
+        int32 UpToDateCount = 0;
+        int32 SkippedCount = 0;
+        TArray<FString> Failures;
+        double Seconds = 0.0;
+    };
+
+    struct FImportItem
+    {
+        FString SheetName;
+        FString CSVFilePath;
+        UScriptStruct* StructObj = nullptr;
+        bool bRowDecoder = false;
+        // Set when importing straight from the workbook, see -Direct
+        FString ExcelFilePath;
+        // Held by pointer : the loaded tables are not safe to relocate with the array
+        TSharedPtr<FDataTableImportData> Data;
+        bool bLoaded = false;
+        FString Error;
+    };
+
+    // Same resolution as the manager tab : a path from the command line, else the one saved by the tab
+    FString GetBuildPath(const FString& InParams, const TCHAR* InSwitch, const FString& InConfigPath)
+    {
+        FString Path;
+        if (FParse::Value(*InParams, InSwitch, Path) == false)
+        {
+            Path = InConfigPath;
+        }
+
+        return Path.IsEmpty() ? Path : FPaths::ConvertRelativePathToFull(Path);
+    }
+
+    bool CheckFolder(const FString& InPath, const TCHAR* InName)
+    {
+        if (InPath.IsEmpty() || FPaths::DirectoryExists(InPath) == false)
+        {
+            UE_LOG(LogTemp, Error, TEXT("%s Folder Path is not exist or invalid : '%s'"), InName, *InPath);
+            return false;
+        }
+        return true;
+    }
+
+    // Pulls indices from a shared counter with at most InWorkerCount bodies, like DataTableBatchJob
+    template<typename FuncType>
+    void ForEachOnWorkers(int32 InCount, int32 InWorkerCount, FuncType&& InFunc)
+    {
+        std::atomic<int32> NextIndex(0);
+        ParallelFor(FMath::Clamp(InWorkerCount, 1, FMath::Max(InCount, 1)), [&](int32)
+        {
+            for (int32 Index = NextIndex++; Index < InCount; Index = NextIndex++)
+            {
+                InFunc(Index);
+            }
+        });
+    }
+}
+
+UDataTableBuildCommandlet::UDataTableBuildCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = true;
+    LogToConsole = true;
+    ShowErrorCount = true;
+}
+
+int32 UDataTableBuildCommandlet::Main(const FString& Params)
+{
+    const UDataTableManagerConfig* Config = GetDefault<UDataTableManagerConfig>();
+    const FString ExcelFolderPath = GetBuildPath(Params, TEXT("Excel="), Config->CachedExcelPath);
+    const FString CSVFolderPath = GetBuildPath(Params, TEXT("CSV="), Config->CachedCSVPath);
+    const FString StructFolderPath = GetBuildPath(Params, TEXT("Struct="), Config->CachedStructPath);
+    const FString AssetFolderPath = GetBuildPath(Params, TEXT("Asset="), Config->CachedAssetPath);
+
+    int32 WorkerCount = FTaskGraphInterface::Get().GetNumWorkerThreads();
+    FParse::Value(*Params, TEXT("Workers="), WorkerCount);
+    WorkerCount = FMath::Max(WorkerCount, 1);
+
+    const bool bForce = FParse::Param(*Params, TEXT("Force"));
+    const bool bRunCSV = FParse::Param(*Params, TEXT("SkipCSV")) == false;
+    const bool bRunStruct = FParse::Param(*Params, TEXT("SkipStruct")) == false;
+    const bool bRunImport = FParse::Param(*Params, TEXT("SkipImport")) == false;
+    const bool bDirectImport = FParse::Param(*Params, TEXT("Direct"));
+    const bool bWriteSheetCache = FParse::Param(*Params, TEXT("SheetCache"));
+    const bool bHeaderPerSheet = FParse::Param(*Params, TEXT("HeaderPerSheet"));
+
+    if ((bRunCSV || bRunStruct || (bRunImport && bDirectImport)) && CheckFolder(ExcelFolderPath, TEXT("Excel")) == false)
+    {
+        return 1;
+    }
+    if (CheckFolder(CSVFolderPath, TEXT("CSV")) == false
+        || (bRunStruct && CheckFolder(StructFolderPath, TEXT("Struct")) == false)
+        || (bRunImport && CheckFolder(AssetFolderPath, TEXT("Asset")) == false))
+    {
+        return 1;
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("DataTableBuild : Excel '%s', CSV '%s', Struct '%s', Asset '%s', %d workers%s"),
+        *ExcelFolderPath, *CSVFolderPath, *StructFolderPath, *AssetFolderPath, WorkerCount, bForce ? TEXT(", forced") : TEXT(""));
+
+    const double BuildStartTime = FPlatformTime::Seconds();
+
+    TArray<FString> ExcelFiles;
+    if (bRunCSV || bRunStruct || (bRunImport && bDirectImport))
+    {
+        XlsxManager::FindAllFilesInFolderPath(ExcelFiles, ExcelFolderPath, ".xlsx");
+    }
+
+    // Sheet schemas from the CSV stage, handed to struct generation; empty when the stage is skipped
+    TArray<TMap<FString, FSheetSchema>> WorkbookSchemas;
+    WorkbookSchemas.SetNum(ExcelFiles.Num());
+
+    FBuildStageResult CSVStage;
+    CSVStage.Name = TEXT("CSV");
+    if (bRunCSV)
+    {
+        CSVStage.bRan = true;
+        const double StartTime = FPlatformTime::Seconds();
+
+        // Workbooks are spread over the workers, each workbook splits its share among its sheets
+        const int32 WorkbookWorkers = FMath::Clamp(WorkerCount, 1, FMath::Max(ExcelFiles.Num(), 1));
+        TArray<TArray<FSheetConvertResult>> WorkbookResults;
+        WorkbookResults.SetNum(ExcelFiles.Num());
+        TArray<bool> OpenedWorkbooks;
+        OpenedWorkbooks.Init(true, ExcelFiles.Num());
+
+        ForEachOnWorkers(ExcelFiles.Num(), WorkbookWorkers, [&](int32 Index)
+        {
+            FXlsxConvertOptions ConvertOptions;
+            ConvertOptions.MaxWorkers = FMath::Max(WorkerCount / WorkbookWorkers, 1);
+            ConvertOptions.bForceRebuild = bForce;
+            ConvertOptions.bWriteSheetCache = bWriteSheetCache;
+
+            if (XlsxManager::ConvertAllSheetInXlsx(ExcelFiles[Index], CSVFolderPath, ConvertOptions, &WorkbookResults[Index]) == false
+                && WorkbookResults[Index].Num() == 0)
+            {
+                OpenedWorkbooks[Index] = false;
+            }
+        });
+
+        for (int32 Index = 0; Index < ExcelFiles.Num(); Index++)
+        {
+            const FString ExcelName = FPaths::GetCleanFilename(ExcelFiles[Index]);
+            if (OpenedWorkbooks[Index] == false)
+            {
+                CSVStage.Failures.Add(ExcelName);
+                continue;
+            }
+
+            for (const FSheetConvertResult& Result : WorkbookResults[Index])
+            {
+                if (Result.bSuccess == false)
+                {
+                    CSVStage.Failures.Add(FString::Printf(TEXT("%s / %s : %s"), *ExcelName, *Result.SheetName, *Result.Error));
+                    continue;
+                }
+
+                CSVStage.SucceededCount++;
+                CSVStage.UpToDateCount += Result.bUpToDate ? 1 : 0;
+                WorkbookSchemas[Index].Add(Result.SheetName, Result.Stats.Schema);
+            }
+        }
+
+        CSVStage.Seconds = FPlatformTime::Seconds() - StartTime;
+    }
+
+    FBuildStageResult StructStage;
+    StructStage.Name = TEXT("Struct");
+    if (bRunStruct)
+    {
+        StructStage.bRan = true;
+        const double StartTime = FPlatformTime::Seconds();
+
+        TArray<bool> StructResults;
+        StructResults.Init(true, ExcelFiles.Num());
+        TArray<FStructGenerateStats> StructStats;
+        StructStats.SetNum(ExcelFiles.Num());
+
+        // Every workbook is generated : only header rows are read and files whose content is unchanged are not written
+        ForEachOnWorkers(ExcelFiles.Num(), WorkerCount, [&](int32 Index)
+        {
+            // Header rows straight from the conversion above, no CSV is read for them
+            FStructGenerateOptions StructOptions;
+            StructOptions.bHeaderPerSheet = bHeaderPerSheet;
+            StructOptions.Schemas = &WorkbookSchemas[Index];
+            StructResults[Index] = StructGenerator::GenerateStructFromXlsx(ExcelFiles[Index], CSVFolderPath, StructFolderPath, StructOptions, &StructStats[Index]);
+        });
+
+        for (int32 Index = 0; Index < ExcelFiles.Num(); Index++)
+        {
+            if (StructResults[Index] == false)
+            {
+                StructStage.Failures.Add(FString::Printf(TEXT("%s : Generate Struct Failed"), *FPaths::GetCleanFilename(ExcelFiles[Index])));
+            }
+            else
+            {
+                StructStage.SucceededCount++;
+                StructStage.UpToDateCount += StructStats[Index].HasChanges() ? 0 : 1;
+            }
+        }
+
+        StructStage.Seconds = FPlatformTime::Seconds() - StartTime;
+    }
+
+    FBuildStageResult ImportStage;
+    ImportStage.Name = TEXT("Import");
+    if (bRunImport)
+    {
+        ImportStage.bRan = true;
+        const double StartTime = FPlatformTime::Seconds();
+
+        // Sheet name -> file the table is read from : its CSV, or its workbook with -Direct
+        TArray<TPair<FString, FString>> Sources;
+        if (bDirectImport)
+        {
+            for (const FString& ExcelFile : ExcelFiles)
+            {
+                TArray<FString> SheetNames;
+                XlsxManager::FindAllSheetInExcelFile(SheetNames, ExcelFile);
+                for (const FString& SheetName : SheetNames)
+                {
+                    Sources.Emplace(SheetName, ExcelFile);
+                }
+            }
+        }
+        else
+        {
+            TArray<FString> CSVFiles;
+            XlsxManager::FindAllFilesInFolderPath(CSVFiles, CSVFolderPath, ".csv");
+            for (const FString& CSVFile : CSVFiles)
+            {
+                Sources.Emplace(FPaths::GetBaseFilename(CSVFile), CSVFile);
+            }
+        }
+
+        IFileManager& FileManager = IFileManager::Get();
+        TArray<FImportItem> Items;
+        for (const TPair<FString, FString>& Source : Sources)
+        {
+            const FString& SheetName = Source.Key;
+            // Row structs compiled into this editor, matched to sheets by name like the manager tab
+            UScriptStruct* StructObj = RowStructIndex::Find(SheetName);
+            if (StructObj == nullptr)
+            {
+                UE_LOG(LogTemp, Warning, TEXT("No row struct for sheet %s, rebuild the project after generating its struct"), *SheetName);
+                ImportStage.SkippedCount++;
+                continue;
+            }
+
+            const FString AssetFilePath = FPaths::Combine(AssetFolderPath, SheetName + FPackageName::GetAssetPackageExtension());
+            if (bForce == false && FileManager.FileExists(*AssetFilePath) && FileManager.GetTimeStamp(*AssetFilePath) >= FileManager.GetTimeStamp(*Source.Value))
+            {
+                ImportStage.SucceededCount++;
+                ImportStage.UpToDateCount++;
+                continue;
+            }
+
+            FImportItem& Item = Items.AddDefaulted_GetRef();
+            Item.SheetName = SheetName;
+            (bDirectImport ? Item.ExcelFilePath : Item.CSVFilePath) = Source.Value;
+            Item.StructObj = StructObj;
+            Item.bRowDecoder = DataTableRowDecoderRegistry::Find(StructObj) != nullptr;
+            Item.Data = MakeShared<FDataTableImportData>();
+        }
+
+        // File reads on the workers, assets and packages on this thread. Items go in batches of one per worker, each batch's
+        // loaded tables are released once built, so only WorkerCount of them are held at a time. The packages are saved in one batch.
+        const double TablesStartTime = FPlatformTime::Seconds();
+        const int32 BatchSize = FMath::Max(WorkerCount, 1);
+        TArray<UDataTable*> BuiltTables;
+        TArray<FString> BuiltSheetNames;
+        FDataTableUpdateStats TotalRowStats;
+        for (int32 BatchStart = 0; BatchStart < Items.Num(); BatchStart += BatchSize)
+        {
+            const int32 BatchCount = FMath::Min(BatchSize, Items.Num() - BatchStart);
+            ForEachOnWorkers(BatchCount, WorkerCount, [&](int32 Index)
+            {
+                FImportItem& Item = Items[BatchStart + Index];
+                Item.bLoaded = DataTableAssetGanerator::LoadForImport(Item.CSVFilePath, Item.ExcelFilePath, Item.SheetName, *Item.Data, &Item.Error, Item.bRowDecoder);
+            });
+
+            for (int32 Index = BatchStart; Index < BatchStart + BatchCount; Index++)
+            {
+                FImportItem& Item = Items[Index];
+                FDataTableUpdateStats RowStats;
+                UDataTable* DataTable = Item.bLoaded ? DataTableAssetGanerator::BuildDataTable(Item.SheetName, *Item.Data, AssetFolderPath, Item.StructObj, &RowStats) : nullptr;
+                if (DataTable != nullptr)
+                {
+                    BuiltTables.Add(DataTable);
+                    BuiltSheetNames.Add(Item.SheetName);
+
+                    // Only tables with changed rows are saved again
+                    ImportStage.UpToDateCount += RowStats.HasChanges() ? 0 : 1;
+                    TotalRowStats += RowStats;
+                }
+                else
+                {
+                    ImportStage.Failures.Add(FString::Printf(TEXT("%s : %s"), *Item.SheetName, Item.bLoaded ? TEXT("Create Data Table Failed") : *Item.Error));
+                }
+
+                Item.Data.Reset();
+            }
+        }
+
+        const double SaveStartTime = FPlatformTime::Seconds();
+        TArray<UDataTable*> FailedTables;
+        DataTableAssetGanerator::SaveDataTables(BuiltTables, &FailedTables);
+
+        for (int32 Index = 0; Index < BuiltTables.Num(); Index++)
+        {
+            if (FailedTables.Contains(BuiltTables[Index]))
+            {
+                ImportStage.Failures.Add(FString::Printf(TEXT("%s : Save Data Table Failed"), *BuiltSheetNames[Index]));
+            }
+            else
+            {
+                ImportStage.SucceededCount++;
+            }
+        }
+
+        UE_LOG(LogTemp, Display, TEXT("DataTableBuild Import : %d tables loaded and built in %.3f sec, saved in %.3f sec, %d rows added, %d changed, %d removed, %d unchanged, %d tables reordered"),
+            BuiltTables.Num(), SaveStartTime - TablesStartTime, FPlatformTime::Seconds() - SaveStartTime,
+            TotalRowStats.AddedRows, TotalRowStats.ChangedRows, TotalRowStats.RemovedRows, TotalRowStats.UnchangedRows, TotalRowStats.ReorderedTables);
+
+        ImportStage.Seconds = FPlatformTime::Seconds() - StartTime;
+    }
+
+    int32 FailedCount = 0;
+    for (const FBuildStageResult* Stage : { &CSVStage, &StructStage, &ImportStage })
+    {
+        if (Stage->bRan == false)
+        {
+            UE_LOG(LogTemp, Display, TEXT("DataTableBuild %-6s : skipped"), Stage->Name);
+            continue;
+        }
+
+        UE_LOG(LogTemp, Display, TEXT("DataTableBuild %-6s : %d succeeded (%d up to date), %d skipped, %d failed in %.3f sec"),
+            Stage->Name, Stage->SucceededCount, Stage->UpToDateCount, Stage->SkippedCount, Stage->Failures.Num(), Stage->Seconds);
+
+        for (const FString& Failure : Stage->Failures)
+        {
+            UE_LOG(LogTemp, Error, TEXT("DataTableBuild %-6s : %s"), Stage->Name, *Failure);
+        }
+
+        FailedCount += Stage->Failures.Num();
+    }
+
+    UE_LOG(LogTemp, Display, TEXT("DataTableBuild finished in %.3f sec with %d failures"), FPlatformTime::Seconds() - BuildStartTime, FailedCount);
+    return FailedCount == 0 ? 0 : 1;
+}
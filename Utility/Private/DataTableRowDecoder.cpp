@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "DataTableRowDecoder.h"
+#include "Misc/ScopeLock.h"
+
+#include <charconv>
+#include <cmath>
+#include <type_traits>
+
+using namespace std;
+
+// Decoders registered from static initialization of other modules, so both are created on first use
+static FCriticalSection& GetRegistryLock()
+{
+    static FCriticalSection Lock;
+    return Lock;
+}
+
+static TArray<const FDataTableRowDecoder*>& GetRegisteredDecoders()
+{
+    static TArray<const FDataTableRowDecoder*> Decoders;
+    return Decoders;
+}
+
+DataTableRowDecoderRegistry::DataTableRowDecoderRegistry()
+{
+}
+
+DataTableRowDecoderRegistry::~DataTableRowDecoderRegistry()
+{
+}
+
+FDataTableRowDecoder::FDataTableRowDecoder(FGetRowStruct InGetRowStruct, uint32 InStructSize, TArrayView<const FDataTableDecoderField> InFields)
+    : GetRowStructFunc(InGetRowStruct)
+    , StructSize(InStructSize)
+    , Fields(InFields)
+{
+}
+
+FDataTableRowDecoder::FDataTableRowDecoder(const UScriptStruct* InRowStruct, TArrayView<const FDataTableDecoderField> InFields)
+    : RowStruct(InRowStruct)
+    , StructSize(static_cast<uint32>(InRowStruct->GetStructureSize()))
+    , Fields(InFields)
+{
+}
+
+const UScriptStruct* FDataTableRowDecoder::GetRowStruct() const
+{
+    return RowStruct != nullptr ? RowStruct : GetRowStructFunc();
+}
+
+int32 FDataTableRowDecoder::FindField(const FName& InPropertyName) const
+{
+    for (int32 Index = 0; Index < Fields.Num(); Index++)
+    {
+        if (InPropertyName == FName(Fields[Index].Name))
+        {
+            return Index;
+        }
+    }
+    return INDEX_NONE;
+}
+
+// The whole text must be the number, anything from_chars stops early on is left to reflection
+template<typename NumberType>
+static bool DecodeNumber(string_view InText, uint8* OutValue)
+{
+    NumberType Value;
+    const from_chars_result Result = from_chars(InText.data(), InText.data() + InText.size(), Value);
+    if (InText.empty() || Result.ec != errc() || Result.ptr != InText.data() + InText.size())
+    {
+        return false;
+    }
+
+    // from_chars also reads "inf" and "nan", which ImportText rejects; reflection reports them the same way on both paths
+    if constexpr (is_floating_point_v<NumberType>)
+    {
+        if (isfinite(Value) == false)
+        {
+            return false;
+        }
+    }
+
+    *reinterpret_cast<NumberType*>(OutValue) = Value;
+    return true;
+}
+
+static bool EqualsIgnoreCase(string_view InText, string_view InLower)
+{
+    if (InText.size() != InLower.size())
+    {
+        return false;
+    }
+
+    for (size_t Index = 0; Index < InText.size(); Index++)
+    {
+        if (FChar::ToLower(static_cast<TCHAR>(InText[Index])) != static_cast<TCHAR>(InLower[Index]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool DecodeBool(string_view InText, uint8* OutValue)
+{
+    bool Value;
+    if (InText == "1" || EqualsIgnoreCase(InText, "true"))
+    {
+        Value = true;
+    }
+    else if (InText == "0" || EqualsIgnoreCase(InText, "false"))
+    {
+        Value = false;
+    }
+    else
+    {
+        return false;
+    }
+
+    *reinterpret_cast<bool*>(OutValue) = Value;
+    return true;
+}
+
+// FName import reads one token, so only text that is a whole token on its own is decoded
+static bool DecodeName(string_view InText, uint8* OutValue)
+{
+    if (InText.empty() || InText.size() >= NAME_SIZE)
+    {
+        return false;
+    }
+
+    for (const char Char : InText)
+    {
+        const bool bTokenChar = (Char >= 'a' && Char <= 'z') || (Char >= 'A' && Char <= 'Z') || (Char >= '0' && Char <= '9')
+            || Char == '_' || Char == '-' || Char == '+';
+        if (bTokenChar == false)
+        {
+            return false;
+        }
+    }
+
+    const FUTF8ToTCHAR Converted(InText.data(), static_cast<int32>(InText.size()));
+    *reinterpret_cast<FName*>(OutValue) = FName(Converted.Length(), Converted.Get());
+    return true;
+}
+
+static bool DecodeString(string_view InText, uint8* OutValue)
+{
+    const FUTF8ToTCHAR Converted(InText.data(), static_cast<int32>(InText.size()));
+    FString& Value = *reinterpret_cast<FString*>(OutValue);
+    Value.Reset();
+    Value.AppendChars(Converted.Get(), Converted.Length());
+    return true;
+}
+
+bool FDataTableRowDecoder::DecodeCell(int32 InField, string_view InText, uint8* OutRowData) const
+{
+    const FDataTableDecoderField& Field = Fields[InField];
+    uint8* Value = OutRowData + Field.Offset;
+
+    switch (Field.Type)
+    {
+    case EDataTableFieldType::Int8:
+        return DecodeNumber<int8>(InText, Value);
+    case EDataTableFieldType::UInt8:
+        return DecodeNumber<uint8>(InText, Value);
+    case EDataTableFieldType::Int16:
+        return DecodeNumber<int16>(InText, Value);
+    case EDataTableFieldType::UInt16:
+        return DecodeNumber<uint16>(InText, Value);
+    case EDataTableFieldType::Int32:
+        return DecodeNumber<int32>(InText, Value);
+    case EDataTableFieldType::UInt32:
+        return DecodeNumber<uint32>(InText, Value);
+    case EDataTableFieldType::Int64:
+        return DecodeNumber<int64>(InText, Value);
+    case EDataTableFieldType::UInt64:
+        return DecodeNumber<uint64>(InText, Value);
+    case EDataTableFieldType::Float:
+        return DecodeNumber<float>(InText, Value);
+    case EDataTableFieldType::Double:
+        return DecodeNumber<double>(InText, Value);
+    case EDataTableFieldType::Bool:
+        return DecodeBool(InText, Value);
+    case EDataTableFieldType::String:
+        return DecodeString(InText, Value);
+    case EDataTableFieldType::Name:
+        return DecodeName(InText, Value);
+    }
+
+    return false;
+}
+
+void DataTableRowDecoderRegistry::Register(const FDataTableRowDecoder& InDecoder)
+{
+    FScopeLock Lock(&GetRegistryLock());
+    GetRegisteredDecoders().AddUnique(&InDecoder);
+}
+
+void DataTableRowDecoderRegistry::Unregister(const FDataTableRowDecoder& InDecoder)
+{
+    FScopeLock Lock(&GetRegistryLock());
+    GetRegisteredDecoders().Remove(&InDecoder);
+}
+
+const FDataTableRowDecoder* DataTableRowDecoderRegistry::Find(const UScriptStruct* InRowStruct)
+{
+    if (InRowStruct == nullptr)
+    {
+        return nullptr;
+    }
+
+    FScopeLock Lock(&GetRegistryLock());
+
+    // Searched from the end : after a hot reload the newest module's decoder wins
+    const TArray<const FDataTableRowDecoder*>& Decoders = GetRegisteredDecoders();
+    for (int32 Index = Decoders.Num() - 1; Index >= 0; Index--)
+    {
+        const FDataTableRowDecoder* Decoder = Decoders[Index];
+        if (Decoder->GetRowStruct() == InRowStruct)
+        {
+            return Decoder->GetStructSize() == static_cast<uint32>(InRowStruct->GetStructureSize()) ? Decoder : nullptr;
+        }
+    }
+
+    return nullptr;
+}
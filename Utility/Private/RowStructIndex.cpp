@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RowStructIndex.h"
+#include "Engine/DataTable.h"
+#include "Modules/ModuleManager.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/UObjectIterator.h"
+
+namespace
+{
+    TMap<FName, TWeakObjectPtr<UScriptStruct>> IndexedStructs;
+    bool bBuilt = false;
+
+    FDelegateHandle ModulesChangedHandle;
+    FDelegateHandle ReloadCompleteHandle;
+
+    FRowStructIndexStats Stats;
+}
+
+RowStructIndex::RowStructIndex()
+{
+}
+
+RowStructIndex::~RowStructIndex()
+{
+}
+
+void RowStructIndex::Startup()
+{
+    ModulesChangedHandle = FModuleManager::Get().OnModulesChanged().AddLambda([](FName InModuleName, EModuleChangeReason InReason)
+    {
+        // Nothing to keep current before the first lookup builds the index
+        if (bBuilt == false)
+        {
+            return;
+        }
+
+        if (InReason == EModuleChangeReason::ModuleLoaded)
+        {
+            AddModuleStructs(InModuleName);
+        }
+        // Structs of an unloaded module go stale in place and are dropped when found
+    });
+
+    // Hot reload and Live Coding replace structs in existing packages, the old objects are renamed and kept
+    ReloadCompleteHandle = FCoreUObjectDelegates::ReloadCompleteDelegate.AddLambda([](EReloadCompleteReason InReason)
+    {
+        Invalidate();
+    });
+}
+
+void RowStructIndex::Shutdown()
+{
+    FModuleManager::Get().OnModulesChanged().Remove(ModulesChangedHandle);
+    FCoreUObjectDelegates::ReloadCompleteDelegate.Remove(ReloadCompleteHandle);
+
+    IndexedStructs.Empty();
+    bBuilt = false;
+}
+
+UScriptStruct* RowStructIndex::Find(const FString& InStructName)
+{
+    check(IsInGameThread());
+    EnsureBuilt();
+
+    // FNAME_Find : a sheet without a struct must not add its name to the name table
+    const FName StructName(*InStructName, FNAME_Find);
+    if (StructName.IsNone())
+    {
+        return nullptr;
+    }
+
+    const TWeakObjectPtr<UScriptStruct>* Found = IndexedStructs.Find(StructName);
+    if (Found == nullptr)
+    {
+        return nullptr;
+    }
+
+    UScriptStruct* Struct = Found->Get();
+    if (Struct == nullptr)
+    {
+        IndexedStructs.Remove(StructName);
+        Stats.IndexedStructs = IndexedStructs.Num();
+        return nullptr;
+    }
+    return Struct;
+}
+
+void RowStructIndex::GetAll(TArray<UScriptStruct*>& OutStructs)
+{
+    check(IsInGameThread());
+    EnsureBuilt();
+
+    OutStructs.Reset(IndexedStructs.Num());
+    for (const TPair<FName, TWeakObjectPtr<UScriptStruct>>& Pair : IndexedStructs)
+    {
+        if (UScriptStruct* Struct = Pair.Value.Get())
+        {
+            OutStructs.Add(Struct);
+        }
+    }
+}
+
+FRowStructIndexStats RowStructIndex::GetStats()
+{
+    return Stats;
+}
+
+void RowStructIndex::Invalidate()
+{
+    IndexedStructs.Empty();
+    bBuilt = false;
+}
+
+void RowStructIndex::EnsureBuilt()
+{
+    if (bBuilt)
+    {
+        return;
+    }
+
+    IndexedStructs.Empty();
+    for (TObjectIterator<UScriptStruct> It; It; ++It)
+    {
+        AddStruct(*It);
+    }
+
+    bBuilt = true;
+    Stats.FullScans++;
+    Stats.IndexedStructs = IndexedStructs.Num();
+}
+
+void RowStructIndex::AddStruct(UScriptStruct* InStruct)
+{
+    if (InStruct == FTableRowBase::StaticStruct() || InStruct->IsChildOf(FTableRowBase::StaticStruct()) == false)
+    {
+        return;
+    }
+
+    // Leftovers of a hot reload keep their outer but are renamed, so they never shadow the live struct
+    TWeakObjectPtr<UScriptStruct>& Entry = IndexedStructs.FindOrAdd(InStruct->GetFName());
+    if (Entry.IsValid() == false)
+    {
+        Entry = InStruct;
+    }
+}
+
+void RowStructIndex::AddModuleStructs(FName InModuleName)
+{
+    // Reflected types of a module live in its /Script package, registered before the module reports loaded
+    UPackage* Package = FindPackage(nullptr, *(TEXT("/Script/") + InModuleName.ToString()));
+    if (Package == nullptr)
+    {
+        return;
+    }
+
+    ForEachObjectWithPackage(Package, [](UObject* InObject)
+    {
+        if (UScriptStruct* Struct = Cast<UScriptStruct>(InObject))
+        {
+            AddStruct(Struct);
+        }
+        return true;
+    }, false);
+
+    Stats.ModuleScans++;
+    Stats.IndexedStructs = IndexedStructs.Num();
+}
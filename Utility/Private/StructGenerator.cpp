@@ -4,11 +4,22 @@
 #include "StructGenerator.h"
 #include "Misc/FileHelper.h"
 #include "HAL/PlatformFileManager.h"
+#include "Misc/ScopeLock.h"
+#include "XlsxWorkbookCache.h"
+#include "XlsxManager.h"
+#include "DataTypeTokenTable.h"
+#include "SheetCsvConverter.h"
 
+#if PLATFORM_WINDOWS
 using namespace OpenXLSX;
+#endif
 using namespace std;
 
-static TMap<FString, FString> ValidType = { {"long double", "double"}, {"string", "FString"}, {"fstring", "FString"}, {"text", "FText"}, {"ftext", "FText"} };
+// Workbooks generated at the same time share the struct folder : ownership checks, writes and removals of one
+// workbook are done together so another cannot claim or delete a file in between
+static FCriticalSection GeneratedFilesLock;
+
+static constexpr const char* SourceWorkbookPrefix = "// Source workbook : ";
 
 StructGenerator::StructGenerator()
 {
@@ -18,37 +29,199 @@ StructGenerator::~StructGenerator()
 {
 }
 
-bool StructGenerator::GenerateStructFromXlsx(const FString& InXlsxFilePath, const FString& InCSVFolderPath, const FString& OutStructFolderPath)
+bool StructGenerator::GenerateStructFromXlsx(const FString& InXlsxFilePath, const FString& InCSVFolderPath, const FString& OutStructFolderPath,
+	const FStructGenerateOptions& InOptions, FStructGenerateStats* OutStats)
 {
-	XLDocument Doc;
-	Doc.open(TCHAR_TO_UTF8(*InXlsxFilePath));
-	if (Doc.isOpen() == false)
+	// Only the sheet names are needed, usually already cached by sheet listing or CSV conversion
+	XlsxWorkbookCache::FReaderPtr Reader = XlsxWorkbookCache::Acquire(InXlsxFilePath);
+	if (Reader.IsValid() == false)
 	{
 		UE_LOG(LogTemp, Error, TEXT("Failed to Open Excel File"));
 		return false;
 	}
 
-	string HeaderName = Doc.name();
-	HeaderName.erase(HeaderName.end() - 5, HeaderName.end());
-	ofstream HeaderFile(*FPaths::Combine(OutStructFolderPath, (HeaderName + ".h").c_str()));
-	if (HeaderFile.fail())
+	if (OutStructFolderPath.IsEmpty() || FPaths::DirectoryExists(OutStructFolderPath) == false)
 	{
 		UE_LOG(LogTemp, Error, TEXT("Please check if Struct and Public folders exist"));
 		return false;
 	}
 
+	const vector<string>& SheetNames = Reader->GetSheetNames();
+	string HeaderName = TCHAR_TO_UTF8(*FPaths::GetBaseFilename(InXlsxFilePath));
+
+	// Every sheet needs its schema : a partial set would drop the later sheets' structs or write a truncated header
+	TArray<FSheetSchema> Schemas;
+	if (FindSheetSchemas(SheetNames, InCSVFolderPath, InOptions.Schemas, Schemas) == false)
+	{
+		UE_LOG(LogTemp, Error, TEXT("No schema for sheet %s of %s, convert it to CSV first. Nothing was generated for this workbook."),
+			UTF8_TO_TCHAR(SheetNames[Schemas.Num()].c_str()), *FPaths::GetCleanFilename(InXlsxFilePath));
+		return false;
+	}
+
+	const string WorkbookName = TCHAR_TO_UTF8(*FPaths::GetCleanFilename(InXlsxFilePath));
+
+	FScopeLock Lock(&GeneratedFilesLock);
+
+	// A header generated for another workbook is never replaced, e.g. a sheet named like another workbook in per-sheet mode
+	const vector<string> WrittenHeaders = InOptions.bHeaderPerSheet ? SheetNames : vector<string>{ HeaderName };
+	for (const string& WrittenHeader : WrittenHeaders)
+	{
+		for (const char* Suffix : { ".h", "RowDecoders.cpp" })
+		{
+			const FString FilePath = FPaths::Combine(OutStructFolderPath, (WrittenHeader + Suffix).c_str());
+			string Owner;
+			if (ReadGeneratedFileOwner(FilePath, Owner) && Owner.empty() == false && Owner != WorkbookName)
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s was generated from %s, rename the sheet or workbook. Nothing was generated for %s."),
+					*FilePath, UTF8_TO_TCHAR(Owner.c_str()), *FPaths::GetCleanFilename(InXlsxFilePath));
+				return false;
+			}
+		}
+	}
+
+	FStructGenerateStats Stats;
+	bool bResult = true;
+	if (InOptions.bHeaderPerSheet)
+	{
+		// A struct defined in both layouts would not compile
+		if (find(SheetNames.begin(), SheetNames.end(), HeaderName) == SheetNames.end())
+		{
+			RemoveGeneratedFiles(OutStructFolderPath, HeaderName, WorkbookName, Stats);
+		}
+
+		for (int32 Index = 0; Index < Schemas.Num(); Index++)
+		{
+			TArray<FSheetSchema> SheetSchema;
+			SheetSchema.Add(Schemas[Index]);
+			bResult &= WriteGeneratedFiles(OutStructFolderPath, SheetNames[Index], WorkbookName, { SheetNames[Index] }, SheetSchema, Stats);
+		}
+	}
+	else
+	{
+		for (const string& SheetName : SheetNames)
+		{
+			if (SheetName != HeaderName)
+			{
+				RemoveGeneratedFiles(OutStructFolderPath, SheetName, WorkbookName, Stats);
+			}
+		}
+
+		bResult = WriteGeneratedFiles(OutStructFolderPath, HeaderName, WorkbookName, SheetNames, Schemas, Stats);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Generated structs of %s : %d files written, %d unchanged, %d removed"),
+		*FPaths::GetCleanFilename(InXlsxFilePath), Stats.WrittenFiles, Stats.UnchangedFiles, Stats.RemovedFiles);
+
+	if (OutStats != nullptr)
+	{
+		*OutStats = Stats;
+	}
+	return bResult;
+}
+
+bool StructGenerator::WriteGeneratedFiles(const FString& OutStructFolderPath, const std::string& InHeaderName, const std::string& InWorkbookName,
+	const std::vector<std::string>& InSheetNames, const TArray<FSheetSchema>& InSchemas, FStructGenerateStats& OutStats)
+{
+	ostringstream HeaderFile;
 	WriteBasicInformation(HeaderFile);
-	WriteInclude(HeaderFile, HeaderName);
-	WriteStruct(HeaderFile, Doc, InCSVFolderPath);
+	WriteSourceWorkbook(HeaderFile, InWorkbookName);
+	WriteInclude(HeaderFile, InHeaderName);
+	WriteStruct(HeaderFile, InSheetNames, InSchemas);
+
+	// Compiled with the header; the importer finds the decoders once the module that holds them is loaded
+	ostringstream DecoderFile;
+	WriteBasicInformation(DecoderFile);
+	WriteSourceWorkbook(DecoderFile, InWorkbookName);
+	WriteRowDecoders(DecoderFile, InHeaderName, InSheetNames, InSchemas);
+
+	return WriteFileIfChanged(FPaths::Combine(OutStructFolderPath, (InHeaderName + ".h").c_str()), HeaderFile.str(), OutStats)
+		&& WriteFileIfChanged(FPaths::Combine(OutStructFolderPath, (InHeaderName + "RowDecoders.cpp").c_str()), DecoderFile.str(), OutStats);
+}
+
+bool StructGenerator::WriteFileIfChanged(const FString& InFilePath, const std::string& InContent, FStructGenerateStats& OutStats)
+{
+	// Same size first, so a changed schema usually costs no read at all
+	if (IFileManager::Get().FileSize(*InFilePath) == static_cast<int64>(InContent.size()))
+	{
+		TArray64<uint8> Existing;
+		if (FFileHelper::LoadFileToArray(Existing, *InFilePath) && FMemory::Memcmp(Existing.GetData(), InContent.data(), InContent.size()) == 0)
+		{
+			OutStats.UnchangedFiles++;
+			return true;
+		}
+	}
 
-	HeaderFile.close();
-	Doc.close();
+	if (FFileHelper::SaveArrayToFile(TArrayView64<const uint8>(reinterpret_cast<const uint8*>(InContent.data()), static_cast<int64>(InContent.size())), *InFilePath) == false)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write %s"), *InFilePath);
+		return false;
+	}
 
-	UE_LOG(LogTemp, Display, TEXT("Success Generate Struct"));
+	OutStats.WrittenFiles++;
 	return true;
 }
 
-bool StructGenerator::WriteBasicInformation(std::ofstream& InOpenedFile)
+void StructGenerator::RemoveGeneratedFiles(const FString& OutStructFolderPath, const std::string& InHeaderName, const std::string& InWorkbookName, FStructGenerateStats& OutStats)
+{
+	for (const char* Suffix : { ".h", "RowDecoders.cpp" })
+	{
+		const FString FilePath = FPaths::Combine(OutStructFolderPath, (InHeaderName + Suffix).c_str());
+
+		// Hand-written files that happen to share the name, and files of other workbooks, are kept
+		string Owner;
+		const bool bGenerated = ReadGeneratedFileOwner(FilePath, Owner);
+		if (bGenerated && Owner.empty())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Keeping %s : it does not record the workbook it was generated from, delete it by hand if it is stale"), *FilePath);
+		}
+		if (bGenerated == false || Owner != InWorkbookName)
+		{
+			continue;
+		}
+
+		if (IFileManager::Get().Delete(*FilePath))
+		{
+			OutStats.RemovedFiles++;
+		}
+	}
+}
+
+bool StructGenerator::ReadGeneratedFileOwner(const FString& InFilePath, std::string& OutWorkbookName)
+{
+	OutWorkbookName.clear();
+
+	ostringstream Banner;
+	WriteBasicInformation(Banner);
+	const string BannerText = Banner.str();
+
+	if (IFileManager::Get().FileSize(*InFilePath) < static_cast<int64>(BannerText.size()))
+	{
+		return false;
+	}
+
+	TArray64<uint8> Existing;
+	if (FFileHelper::LoadFileToArray(Existing, *InFilePath) == false || FMemory::Memcmp(Existing.GetData(), BannerText.data(), BannerText.size()) != 0)
+	{
+		return false;
+	}
+
+	// Files generated before owners were recorded have no source line and stay unowned
+	const string_view Rest(reinterpret_cast<const char*>(Existing.GetData()) + BannerText.size(), static_cast<size_t>(Existing.Num()) - BannerText.size());
+	const string_view Prefix(SourceWorkbookPrefix);
+	if (Rest.substr(0, Prefix.size()) == Prefix)
+	{
+		string_view Line = Rest.substr(Prefix.size());
+		Line = Line.substr(0, Line.find('\n'));
+		if (Line.empty() == false && Line.back() == '\r')
+		{
+			Line.remove_suffix(1);
+		}
+		OutWorkbookName.assign(Line.data(), Line.size());
+	}
+	return true;
+}
+
+bool StructGenerator::WriteBasicInformation(std::ostream& InOpenedFile)
 {
 	InOpenedFile << "// Copyright Epic Games, Inc. All Rights Reserved." << endl;
 	InOpenedFile << "// Generated by Lee HoSoung." << endl;
@@ -58,7 +231,14 @@ bool StructGenerator::WriteBasicInformation(std::ofstream& InOpenedFile)
 	return true;
 }
 
-bool StructGenerator::WriteInclude(std::ofstream& InOpenedFile, const std::string& InHeaderName)
+bool StructGenerator::WriteSourceWorkbook(std::ostream& InOpenedFile, const std::string& InWorkbookName)
+{
+	InOpenedFile << SourceWorkbookPrefix << InWorkbookName << endl << endl;
+
+	return true;
+}
+
+bool StructGenerator::WriteInclude(std::ostream& InOpenedFile, const std::string& InHeaderName)
 {
 	InOpenedFile << "#pragma once" << endl << endl;
 	InOpenedFile << "#include \"CoreMinimal.h\"" << endl;
@@ -68,62 +248,164 @@ bool StructGenerator::WriteInclude(std::ofstream& InOpenedFile, const std::strin
 	return true;
 }
 
-bool StructGenerator::WriteStruct(std::ofstream& InOpenedFile, OpenXLSX::XLDocument& InOpenedDoc, const FString& InCSVFolderPath)
+bool StructGenerator::WriteStruct(std::ostream& InOpenedFile, const std::vector<std::string>& InSheetNames, const TArray<FSheetSchema>& InSchemas)
 {
-	vector<string> WorkSheetNames = InOpenedDoc.workbook().worksheetNames();
-
-	for (int Num1 = 0; Num1 < WorkSheetNames.size(); Num1++)
+	for (int Num1 = 0; Num1 < InSchemas.Num(); Num1++)
 	{
-		XLWorksheet Wks = InOpenedDoc.workbook().worksheet(WorkSheetNames[Num1]);
-		
-		FString FileContent;
-		FString CSVPath = FPaths::ConvertRelativePathToFull(InCSVFolderPath);
-		FFileHelper::LoadFileToString(FileContent, *FPaths::Combine(CSVPath, Wks.name().append(".csv").c_str()));
+		const string& SheetName = InSheetNames[Num1];
+		const FSheetSchema& Schema = InSchemas[Num1];
 
-		TArray<FString> Lines, VarNames, VarTypes;
-		FileContent.ParseIntoArrayLines(Lines);
+		InOpenedFile << "USTRUCT(BlueprintType)" << endl;
+		InOpenedFile << "struct " << "F" << SheetName << " : public FTableRowBase" << endl;
+		InOpenedFile << "{" << endl;
+		InOpenedFile << "    GENERATED_BODY()" << endl << endl;
 
-		if (Lines.Num() < 2)
+		for (int Num2 = 0; Num2 < Schema.Names.Num(); Num2++)
 		{
-			return false;
+			FString UnrealType = GetUnrealType(Schema.Types[Num2]);
+
+			InOpenedFile << "	UPROPERTY(EditAnywhere, BlueprintReadWrite)" << endl;
+			InOpenedFile << "	" << string(TCHAR_TO_UTF8(*UnrealType)) << " " << string(TCHAR_TO_UTF8(*Schema.Names[Num2])) << ";" << endl << endl;
 		}
 
-		Lines[0].ParseIntoArray(VarTypes, TEXT(","));
-		Lines[1].ParseIntoArray(VarNames, TEXT(","));
+		InOpenedFile << "};" << endl;
+	}
+
+	return true;
+}
+
+bool StructGenerator::WriteRowDecoders(std::ostream& InOpenedFile, const std::string& InHeaderName, const std::vector<std::string>& InSheetNames, const TArray<FSheetSchema>& InSchemas)
+{
+	InOpenedFile << "#include \"" + InHeaderName + ".h\"" << endl << endl;
+
+	// Modules that do not depend on DataTableModule, and game builds, import through reflection as before
+	InOpenedFile << "#if WITH_EDITOR && __has_include(\"DataTableRowDecoder.h\")" << endl;
+	InOpenedFile << "#include \"DataTableRowDecoder.h\"" << endl;
 
-		if (VarTypes.Num() < 2 || VarNames.Num() < 2 || VarNames.Num() != VarTypes.Num())
+	for (int Num1 = 0; Num1 < InSchemas.Num(); Num1++)
+	{
+		const string& SheetName = InSheetNames[Num1];
+		const FSheetSchema& Schema = InSchemas[Num1];
+
+		// Other members are left to reflection, a struct without any decodable member gets no decoder
+		TArray<int32> DecodedMembers;
+		for (int Num2 = 0; Num2 < Schema.Names.Num(); Num2++)
 		{
-			return false;
+			if (IsDecodableType(GetUnrealType(Schema.Types[Num2])))
+			{
+				DecodedMembers.Add(Num2);
+			}
 		}
 
-		InOpenedFile << "USTRUCT(BlueprintType)" << endl;
-		InOpenedFile << "struct " << "F" << Wks.name() << " : public FTableRowBase" << endl;
+		if (DecodedMembers.Num() == 0)
+		{
+			continue;
+		}
+
+		InOpenedFile << endl;
+		InOpenedFile << "static const FDataTableDecoderField G" << SheetName << "DecoderFields[] =" << endl;
 		InOpenedFile << "{" << endl;
-		InOpenedFile << "    GENERATED_BODY()" << endl << endl;
+		for (const int32 Member : DecodedMembers)
+		{
+			InOpenedFile << "	DATATABLE_DECODER_FIELD(F" << SheetName << ", " << string(TCHAR_TO_UTF8(*Schema.Names[Member])) << ")," << endl;
+		}
+		InOpenedFile << "};" << endl << endl;
+
+		InOpenedFile << "static const FDataTableRowDecoder G" << SheetName << "Decoder(&F" << SheetName << "::StaticStruct, sizeof(F" << SheetName << "), G" << SheetName << "DecoderFields);" << endl;
+		InOpenedFile << "static const FDataTableRowDecoderRegistration G" << SheetName << "DecoderRegistration(G" << SheetName << "Decoder);" << endl;
+	}
+
+	InOpenedFile << "#endif" << endl;
 
-		for (int Num2 = 1; Num2 < VarNames.Num(); Num2++)
+	return true;
+}
+
+bool StructGenerator::FindSheetSchemas(const std::vector<std::string>& InSheetNames, const FString& InCSVFolderPath, const TMap<FString, FSheetSchema>* InSchemas, TArray<FSheetSchema>& OutSchemas)
+{
+	const FString CSVPath = FPaths::ConvertRelativePathToFull(InCSVFolderPath);
+
+	// One small JSON read for the whole workbook
+	TMap<FString, FConversionRecord> Records;
+	ConversionManifest::Load(CSVPath, Records);
+
+	// Stops at the first sheet without a schema, which is then InSheetNames[OutSchemas.Num()]
+	OutSchemas.Reset();
+	for (int Num1 = 0; Num1 < InSheetNames.size(); Num1++)
+	{
+		const string& SheetName = InSheetNames[Num1];
+		const FString CSVFilePath = FPaths::Combine(CSVPath, (SheetName + ".csv").c_str());
+
+		FSheetSchema Schema;
+		if (FindSheetSchema(SheetName.c_str(), CSVFilePath, InSchemas, Records, Schema) == false)
 		{
-			FString UnrealType = GetUnrealType(VarTypes[Num2]);
+			return false;
+		}
+		OutSchemas.Add(MoveTemp(Schema));
+	}
 
-			InOpenedFile << "	UPROPERTY(EditAnywhere, BlueprintReadWrite)" << endl;
-			InOpenedFile << "	" << string(TCHAR_TO_UTF8(*UnrealType)) << " " << string(TCHAR_TO_UTF8(*VarNames[Num2])) << ";" << endl << endl;
+	return true;
+}
+
+bool StructGenerator::FindSheetSchema(const FString& InSheetName, const FString& InCSVFilePath, const TMap<FString, FSheetSchema>* InSchemas, const TMap<FString, FConversionRecord>& InRecords, FSheetSchema& OutSchema)
+{
+	if (InSchemas != nullptr)
+	{
+		if (const FSheetSchema* Passed = InSchemas->Find(InSheetName))
+		{
+			if (Passed->IsValid())
+			{
+				OutSchema = *Passed;
+				return true;
+			}
 		}
+	}
 
-		InOpenedFile << "};" << endl;
+	const FConversionRecord* Recorded = InRecords.Find(InSheetName);
+	if (Recorded != nullptr && ConversionManifest::FindSchema(*Recorded, InCSVFilePath, OutSchema))
+	{
+		return true;
 	}
 
+	// Converted before schemas were recorded, or edited by hand : the header lines are all that is read
+	SheetSchema CsvSchema;
+	string ReadError;
+	if (SheetCsvConverter::ReadSchema(filesystem::path(*InCSVFilePath), CsvSchema, ReadError) == false)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to read the header of %s : %s"), *InCSVFilePath, UTF8_TO_TCHAR(ReadError.c_str()));
+		return false;
+	}
+
+	OutSchema = XlsxManager::ToSheetSchema(CsvSchema);
 	return true;
 }
 
 FString StructGenerator::GetUnrealType(const FString& InVarType)
 {
-	FString VarTypeLower = InVarType.ToLower();
-
-	FString* ChangedType = ValidType.Find(VarTypeLower);
-	if (ChangedType != nullptr)
+	// Same vocabulary XlsxManager uses to find the type row
+	const FTCHARToUTF8 VarType(*InVarType);
+	const DataTypeToken* Token = DataTypeTokenTable::Find(std::string_view(VarType.Get(), VarType.Length()));
+	if (Token != nullptr)
 	{
-		return *ChangedType;
+		return FString(static_cast<int32>(Token->UnrealType.size()), Token->UnrealType.data());
 	}
 
 	return InVarType;
 }
+
+bool StructGenerator::IsDecodableType(const FString& InUnrealType)
+{
+	static const TCHAR* DecodableTypes[] =
+	{
+		TEXT("int8"), TEXT("uint8"), TEXT("int16"), TEXT("uint16"), TEXT("int32"), TEXT("uint32"), TEXT("int64"), TEXT("uint64"),
+		TEXT("float"), TEXT("double"), TEXT("bool"), TEXT("FString"), TEXT("FName"),
+	};
+
+	for (const TCHAR* Type : DecodableTypes)
+	{
+		if (InUnrealType.Equals(Type, ESearchCase::CaseSensitive))
+		{
+			return true;
+		}
+	}
+	return false;
+}
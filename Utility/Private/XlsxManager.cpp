@@ -1,12 +1,19 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "XlsxManager.h"
+#include "CsvCellFormatter.h"
+#include "XlsxWorkbookCache.h"
+#include "ConversionManifest.h"
+#include "SheetCsvConverter.h"
+#include "Async/ParallelFor.h"
 
+#include <atomic>
+
+#if PLATFORM_WINDOWS
 using namespace OpenXLSX;
+#endif
 using namespace std;
 
-static TArray<string> ValidType = { "int" , "uint", "int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64", "float" , "double", "bool" , "boolean", "char" , "ansichar","tchar", "fstring" , "ftext","fname" };
-
 XlsxManager::XlsxManager()
 {
 }
@@ -15,9 +22,18 @@ XlsxManager::~XlsxManager()
 {
 }
 
-bool XlsxManager::ConvertAllSheetInXlsx(const FString& InXlsxFilePath, const FString& OutCsvFolderPath)
+bool XlsxManager::ConvertAllSheetInXlsx(const FString& InXlsxFilePath, const FString& OutCsvFolderPath, const FXlsxConvertOptions& InOptions, TArray<FSheetConvertResult>* OutResults)
+{
+    return ConvertSheets(InXlsxFilePath, nullptr, OutCsvFolderPath, InOptions, OutResults);
+}
+
+bool XlsxManager::ConvertSpecificSheet(const FString& InXlsxFilePath, const TArray<FString>& InSheetNames, const FString& OutCsvFolderPath, const FXlsxConvertOptions& InOptions, TArray<FSheetConvertResult>* OutResults)
+{
+    return ConvertSheets(InXlsxFilePath, &InSheetNames, OutCsvFolderPath, InOptions, OutResults);
+}
+
+bool XlsxManager::ConvertSheets(const FString& InXlsxFilePath, const TArray<FString>* InSheetNames, const FString& OutCsvFolderPath, const FXlsxConvertOptions& InOptions, TArray<FSheetConvertResult>* OutResults)
 {
-#if PLATFORM_WINDOWS
     // Check Valid Xlsx File Path
     if (InXlsxFilePath.IsEmpty() || FPaths::FileExists(InXlsxFilePath) == false)
     {
@@ -31,94 +47,168 @@ bool XlsxManager::ConvertAllSheetInXlsx(const FString& InXlsxFilePath, const FSt
         return false;
     }
 
-    try
+    // Shared with sheet listing and struct generation, the workbook is only parsed again once the file changes
+    FString OpenError;
+    XlsxWorkbookCache::FReaderPtr ReaderPtr = XlsxWorkbookCache::Acquire(InXlsxFilePath, &OpenError);
+    if (ReaderPtr.IsValid() == false)
     {
-        XLDocument Doc;
-        Doc.open(TCHAR_TO_UTF8(*InXlsxFilePath));
-
-        //Get all Sheet's name in xlsx file
-        vector<string> WorkSheetNames = Doc.workbook().worksheetNames();
+        UE_LOG(LogTemp, Error, TEXT("Failed to open Xlsx file : %s"), *OpenError);
+        return false;
+    }
+    const XlsxSheetReader& Reader = *ReaderPtr;
 
-        for (int Num = 0; Num < WorkSheetNames.size(); Num++)
+    //Get all Sheet's name in xlsx file
+    vector<string> WorkSheetNames;
+    for (const string& SheetName : Reader.GetSheetNames())
+    {
+        if (InSheetNames == nullptr || InSheetNames->Contains(SheetName.c_str()))
         {
-            XLWorksheet Wks = Doc.workbook().worksheet(WorkSheetNames[Num]);
-
-            bool result = CreateCSV(Wks, OutCsvFolderPath);
-
-            if (result == false)
-            {
-                return false;
-            }
+            WorkSheetNames.push_back(SheetName);
         }
+    }
 
-        Doc.close();
+    const int32 SheetCount = static_cast<int32>(WorkSheetNames.size());
 
-        UE_LOG(LogTemp, Display, TEXT("Success to create Csv file on all sheet"));
-        return true;
-    }
-    catch (const exception& e)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to create Csv file : %s"), *FString(e.what()));
-        return false;
-    }
-#endif
-    UE_LOG(LogTemp, Error, TEXT("This feature is only available on Windows operating systems."));
-    return false;
-}
+    TArray<FSheetConvertResult> Results;
+    Results.SetNum(SheetCount);
 
-bool XlsxManager::ConvertSpecificSheet(const FString& InXlsxFilePath, const TArray<FString>& InSheetNames, const FString& OutCsvFolderPath)
-{
-#if PLATFORM_WINDOWS
-    // Check Valid Xlsx File Path
-    if (InXlsxFilePath.IsEmpty() || FPaths::FileExists(InXlsxFilePath) == false)
+    // What each sheet's CSV is built from : the workbook and the zip entries the sheet reads
+    FConversionRecord WorkbookRecord;
+    WorkbookRecord.WorkbookPath = FPaths::ConvertRelativePathToFull(InXlsxFilePath);
+    WorkbookRecord.WorkbookTimeStamp = IFileManager::Get().GetTimeStamp(*InXlsxFilePath);
+    WorkbookRecord.WorkbookSize = IFileManager::Get().FileSize(*InXlsxFilePath);
+    WorkbookRecord.ConverterVersion = CSV_CONVERTER_VERSION;
+    if (const XlsxArchive::Entry* SharedStrings = Reader.GetArchive().FindEntry(Reader.GetSharedStringsPartName()))
     {
-        UE_LOG(LogTemp, Error, TEXT("Invalid file path for XLSX"));
-        return false;
+        WorkbookRecord.SharedStringsCrc = SharedStrings->Crc32;
     }
-    //Check Valid CSV Folder Path
-    if (OutCsvFolderPath.IsEmpty() || FPaths::DirectoryExists(OutCsvFolderPath) == false)
+
+    TMap<FString, FConversionRecord> RecordedSheets;
+    if (InOptions.bForceRebuild == false)
     {
-        UE_LOG(LogTemp, Error, TEXT("Invalid Folder path for CSV"));
-        return false;
+        ConversionManifest::Load(OutCsvFolderPath, RecordedSheets);
     }
 
-    try
+    TArray<FConversionRecord> SheetRecords;
+    SheetRecords.Init(WorkbookRecord, SheetCount);
+
+    // Each sheet reads its own zip entry and writes its own file, so sheets only share the read-only reader
+    auto ConvertSheet = [&](int32 Index)
     {
-        XLDocument Doc;
-        Doc.open(TCHAR_TO_UTF8(*InXlsxFilePath));
+        FSheetConvertResult& Result = Results[Index];
+        Result.SheetName = WorkSheetNames[Index].c_str();
 
-        //Get all Sheet's name in xlsx file
-        vector<string> WorkSheetNames = Doc.workbook().worksheetNames();
+        const FString CsvFilePath = FPaths::Combine(OutCsvFolderPath, (WorkSheetNames[Index] + CSV_EXTENSION).c_str());
+        FConversionRecord& SheetRecord = SheetRecords[Index];
+        if (const XlsxArchive::Entry* SheetEntry = Reader.GetArchive().FindEntry(Reader.GetSheetPartName(WorkSheetNames[Index])))
+        {
+            SheetRecord.SheetCrc = SheetEntry->Crc32;
+        }
 
-        for (int Num = 0; Num < WorkSheetNames.size(); Num++)
+        const FConversionRecord* Recorded = RecordedSheets.Find(Result.SheetName);
+        FString SheetCachePath;
+
+        if (InOptions.CancelFlag != nullptr && InOptions.CancelFlag->load())
         {
-            if (InSheetNames.Contains(WorkSheetNames[Num].c_str()))
+            Result.bSuccess = false;
+            Result.Error = TEXT("Cancelled");
+        }
+        else if (Recorded != nullptr && ConversionManifest::IsUpToDate(*Recorded, SheetRecord, CsvFilePath)
+            && (InOptions.bWriteSheetCache == false || FindSheetCache(CsvFilePath, SheetCachePath)))
+        {
+            Result.bSuccess = true;
+            Result.bUpToDate = true;
+            Result.Stats.Schema = Recorded->Schema;
+        }
+        else
+        {
+            try
+            {
+                Result.bSuccess = CreateCSV(Reader, WorkSheetNames[Index], OutCsvFolderPath, &Result.Stats, &Result.Error, InOptions.CancelFlag, InOptions.bWriteSheetCache);
+            }
+            catch (const exception& e)
             {
-                XLWorksheet Wks = Doc.workbook().worksheet(WorkSheetNames[Num]);
+                Result.bSuccess = false;
+                Result.Error = e.what();
+            }
 
-                bool result = CreateCSV(Wks, OutCsvFolderPath);
+            if (Result.bSuccess)
+            {
+                SheetRecord.OutputCrc = Result.Stats.OutputCrc;
+                SheetRecord.OutputSize = static_cast<int64>(Result.Stats.OutputBytes);
+                SheetRecord.OutputTimeStamp = IFileManager::Get().GetTimeStamp(*CsvFilePath);
+                SheetRecord.Schema = Result.Stats.Schema;
+            }
+        }
 
-                if (result == false)
-                {
-                    return false;
-                }
+        if (InOptions.OnSheetCompleted)
+        {
+            InOptions.OnSheetCompleted(Result);
+        }
+    };
+
+    const int32 WorkerCount = FMath::Clamp(InOptions.MaxWorkers, 1, FMath::Max(SheetCount, 1));
+    if (WorkerCount == 1)
+    {
+        for (int32 Index = 0; Index < SheetCount; Index++)
+        {
+            ConvertSheet(Index);
+        }
+    }
+    else
+    {
+        // WorkerCount bodies pull sheets from a shared counter, so at most WorkerCount sheets are in flight
+        std::atomic<int32> NextSheet(0);
+        ParallelFor(WorkerCount, [&](int32)
+        {
+            for (int32 Index = NextSheet++; Index < SheetCount; Index = NextSheet++)
+            {
+                ConvertSheet(Index);
             }
+        });
+    }
+
+    int32 FailedCount = 0;
+    int32 UpToDateCount = 0;
+    TMap<FString, FConversionRecord> ConvertedSheets;
+    for (int32 Index = 0; Index < SheetCount; Index++)
+    {
+        const FSheetConvertResult& Result = Results[Index];
+        if (Result.bSuccess == false)
+        {
+            FailedCount++;
+            UE_LOG(LogTemp, Error, TEXT("Failed to create Csv file for sheet %s : %s"), *Result.SheetName, *Result.Error);
+        }
+        else if (Result.bUpToDate)
+        {
+            UpToDateCount++;
+        }
+        else
+        {
+            ConvertedSheets.Add(Result.SheetName, SheetRecords[Index]);
         }
+    }
 
-        UE_LOG(LogTemp, Display, TEXT("Success to create Csv file on all sheet"));
+    ConversionManifest::Update(OutCsvFolderPath, ConvertedSheets);
 
-        Doc.close();
+    if (UpToDateCount > 0)
+    {
+        UE_LOG(LogTemp, Display, TEXT("%d of %d sheets in %s were up to date"), UpToDateCount, SheetCount, *InXlsxFilePath);
+    }
 
-        return true;
+    if (OutResults != nullptr)
+    {
+        *OutResults = MoveTemp(Results);
     }
-    catch (const exception& e)
+
+    if (FailedCount > 0)
     {
-        UE_LOG(LogTemp, Error, TEXT("Failed to create Csv file : %s"), *FString(e.what()));
+        UE_LOG(LogTemp, Error, TEXT("%d of %d sheets failed in %s"), FailedCount, SheetCount, *InXlsxFilePath);
         return false;
     }
-#endif
-    UE_LOG(LogTemp, Error, TEXT("This feature is only available on Windows operating systems."));
-    return false;
+
+    UE_LOG(LogTemp, Display, TEXT("Success to create Csv file on all sheet"));
+    return true;
 }
 
 void XlsxManager::FindAllFilesInFolderPath(TArray<FString>& OutFilesPath, const FString& FolderPath, const FString& Extension)
@@ -149,7 +239,6 @@ void XlsxManager::FindAllFilesInFolderPath(TArray<FString>& OutFilesPath, const
 
 void XlsxManager::FindAllSheetInExcelFile(TArray<FString>& SheetNames, const FString& InXlsxFilePath)
 {
-#if PLATFORM_WINDOWS
     if (FPaths::FileExists(InXlsxFilePath) == false)
     {
         UE_LOG(LogTemp, Error, TEXT("Invalid file path for XLSX"));
@@ -157,28 +246,47 @@ void XlsxManager::FindAllSheetInExcelFile(TArray<FString>& SheetNames, const FSt
 
     SheetNames.Empty();
 
-    try
-    {
-        XLDocument Doc;
-        Doc.open(TCHAR_TO_UTF8(*InXlsxFilePath));
+    TArray<FXlsxSheetInfo> Sheets;
+    ProbeWorkbook(InXlsxFilePath, Sheets);
 
-        //Get all Sheet's name in xlsx file
-        vector<string> WorkSheetNames = Doc.workbook().worksheetNames();
+    //Get all Sheet's name in xlsx file
+    for (const FXlsxSheetInfo& Sheet : Sheets)
+    {
+        SheetNames.Add(Sheet.SheetName);
+    }
+}
 
-        for (int Num = 0; Num < WorkSheetNames.size(); Num++)
-        {
-            SheetNames.Add(WorkSheetNames[Num].c_str());
-        }
+bool XlsxManager::ProbeWorkbook(const FString& InXlsxFilePath, TArray<FXlsxSheetInfo>& OutSheets, bool InbReadDimensions)
+{
+    OutSheets.Empty();
 
-        Doc.close();
+    // Opening a reader is the probe itself : central directory, relationships and workbook.xml only
+    FString OpenError;
+    XlsxWorkbookCache::FReaderPtr Reader = XlsxWorkbookCache::Acquire(InXlsxFilePath, &OpenError);
+    if (Reader.IsValid() == false)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to Search Csv file : %s"), *OpenError);
+        return false;
     }
-    catch (const exception& e)
+
+    for (const string& SheetName : Reader->GetSheetNames())
     {
-        UE_LOG(LogTemp, Error, TEXT("Failed to Search Csv file : %s"), *FString(e.what()));
+        FXlsxSheetInfo& Info = OutSheets.AddDefaulted_GetRef();
+        Info.SheetName = SheetName.c_str();
+
+        XlsxSheetDimension Dimension;
+        if (InbReadDimensions && Reader->ReadDimension(SheetName, Dimension))
+        {
+            Info.Dimension = Dimension.Reference.c_str();
+            Info.LastRow = static_cast<int32>(Dimension.LastRow);
+            Info.LastColumn = static_cast<int32>(Dimension.LastColumn);
+        }
     }
-#endif
+
+    return true;
 }
 
+#if PLATFORM_WINDOWS
 bool XlsxManager::CreateCSV(const XLWorksheet& InWorksheet, const FString& OutCsvFolderPath)
 {
     FString CsvContent;
@@ -191,9 +299,13 @@ bool XlsxManager::CreateCSV(const XLWorksheet& InWorksheet, const FString& OutCs
     int KeyCell = -1;
     int KeyValue = 1;
 
+    // Slot 0 is the key column, filled in place once the row is read. Reset keeps the allocation for the next row.
+    TArray<FString> RowValues;
+
     for (const auto& Row : InWorksheet.rows())
     {
-        TArray<FString> RowValues;
+        RowValues.Reset();
+        RowValues.AddDefaulted();
         int CellNum = 0;
         
         for (const auto& Cell : Row.cells())
@@ -227,11 +339,11 @@ bool XlsxManager::CreateCSV(const XLWorksheet& InWorksheet, const FString& OutCs
             {
                 if (RowNum == StartRow && StringParseAry.size() >= 1)
                 {
-                    RowValues.Add(FString(StringParseAry[0].c_str()));
+                    RowValues.Add(UTF8_TO_TCHAR(StringParseAry[0].c_str()));
                 }
                 else
                 {
-                    RowValues.Add(FString(Ss.str().c_str()));
+                    RowValues.Add(UTF8_TO_TCHAR(Ss.str().c_str()));
                 }
             }
 
@@ -242,16 +354,15 @@ bool XlsxManager::CreateCSV(const XLWorksheet& InWorksheet, const FString& OutCs
         {
             if (StartRow == RowNum || StartRow == RowNum - 1)
             {
-                RowValues.EmplaceAt(0, "Key");
+                RowValues[0] = TEXT("Key");
             }
             else if (KeyCell == -1)
             {
-                RowValues.EmplaceAt(0, FString::FromInt(KeyValue));
+                RowValues[0] = FString::FromInt(KeyValue);
             }
             else
             {
-                FString PutData = RowValues[KeyCell - StartCell];
-                RowValues.EmplaceAt(0, PutData);
+                RowValues[0] = RowValues[KeyCell - StartCell + 1];
             }
 
             CsvContent += FString::Join(RowValues, TEXT(",")) + TEXT("\n");
@@ -260,7 +371,7 @@ bool XlsxManager::CreateCSV(const XLWorksheet& InWorksheet, const FString& OutCs
         RowNum++;
     }
 
-    bool Result = FFileHelper::SaveStringToFile(CsvContent, *FPaths::Combine(OutCsvFolderPath, InWorksheet.name().append(CSV_EXTENSION).c_str()));
+    bool Result = FFileHelper::SaveStringToFile(CsvContent, *FPaths::Combine(OutCsvFolderPath, InWorksheet.name().append(CSV_EXTENSION).c_str()), FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
 
     if (Result == false)
     {
@@ -270,10 +381,88 @@ bool XlsxManager::CreateCSV(const XLWorksheet& InWorksheet, const FString& OutCs
     
     return true;
 }
+#endif
+
+bool XlsxManager::CreateCSV(const XlsxSheetReader& InReader, const std::string& InSheetName, const FString& OutCsvFolderPath, FCsvConvertStats* OutStats, FString* OutError, const std::atomic<bool>* InCancelFlag, bool InbWriteSheetCache)
+{
+    const double StartTime = FPlatformTime::Seconds();
+
+    // Header detection, KEY handling and CSV emission live in the engine independent core
+    const FString CsvFilePath = FPaths::Combine(OutCsvFolderPath, (InSheetName + CSV_EXTENSION).c_str());
+    const FString SheetCachePath = FPaths::ChangeExtension(CsvFilePath, TEXT(SHEET_CACHE_EXTENSION));
+
+    // A cache from an earlier conversion would no longer match the new CSV
+    if (InbWriteSheetCache == false && FPaths::FileExists(SheetCachePath))
+    {
+        IFileManager::Get().Delete(*SheetCachePath);
+    }
+
+    SheetCsvStats CoreStats;
+    string ConvertError;
+    if (SheetCsvConverter::Convert(InReader, InSheetName, filesystem::path(*CsvFilePath), CoreStats, ConvertError, InCancelFlag,
+        InbWriteSheetCache ? filesystem::path(*SheetCachePath) : filesystem::path()) == false)
+    {
+        if (InCancelFlag == nullptr || InCancelFlag->load() == false)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Failed to create Csv file for sheet %s : %s"), *FString(InSheetName.c_str()), UTF8_TO_TCHAR(ConvertError.c_str()));
+        }
+        if (OutError != nullptr)
+        {
+            *OutError = UTF8_TO_TCHAR(ConvertError.c_str());
+        }
+        return false;
+    }
+
+    // The CSV is current either way; without a cache import reads the CSV and the next conversion writes it again
+    if (InbWriteSheetCache && CoreStats.bSheetCacheWritten == false)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Failed to create sheet cache for sheet %s : %s"), *FString(InSheetName.c_str()), UTF8_TO_TCHAR(CoreStats.SheetCacheError.c_str()));
+    }
+
+    FCsvConvertStats Stats;
+    Stats.Rows = CoreStats.Rows;
+    Stats.DataRows = CoreStats.DataRows;
+    Stats.DataRowAllocations = CoreStats.DataRowAllocations;
+    Stats.OutputBytes = CoreStats.OutputBytes;
+    Stats.OutputCrc = CoreStats.OutputCrc;
+    Stats.Schema = ToSheetSchema(CoreStats.Schema);
+    Stats.Seconds = FPlatformTime::Seconds() - StartTime;
+    UE_LOG(LogTemp, Display, TEXT("Converted sheet %s : %d rows in %.3f sec (%.0f rows/sec, %.1f MB/sec)"), *FString(InSheetName.c_str()), Stats.Rows, Stats.Seconds,
+        Stats.Seconds > 0.0 ? Stats.Rows / Stats.Seconds : 0.0, Stats.Seconds > 0.0 ? Stats.OutputBytes / (1024.0 * 1024.0) / Stats.Seconds : 0.0);
+
+    if (OutStats != nullptr)
+    {
+        *OutStats = Stats;
+    }
+
+    return true;
+}
+
+bool XlsxManager::FindSheetCache(const FString& InCSVFilePath, FString& OutSheetCachePath)
+{
+    OutSheetCachePath = FPaths::ChangeExtension(InCSVFilePath, TEXT(SHEET_CACHE_EXTENSION));
+
+    // Written right after its CSV, so an older cache belongs to a previous conversion
+    const FDateTime SheetCacheTimeStamp = IFileManager::Get().GetTimeStamp(*OutSheetCachePath);
+    return SheetCacheTimeStamp != FDateTime::MinValue() && SheetCacheTimeStamp >= IFileManager::Get().GetTimeStamp(*InCSVFilePath);
+}
 
-bool XlsxManager::CheckIsDataTypeCell(std::string InStr)
+FSheetSchema XlsxManager::ToSheetSchema(const SheetSchema& InSchema)
 {
-    std::transform(InStr.begin(), InStr.end(), InStr.begin(), ::tolower);
+    FSheetSchema Schema;
+    for (const string& Type : InSchema.Types)
+    {
+        Schema.Types.Add(UTF8_TO_TCHAR(Type.c_str()));
+    }
+    for (const string& Name : InSchema.Names)
+    {
+        Schema.Names.Add(UTF8_TO_TCHAR(Name.c_str()));
+    }
+    Schema.KeyColumn = InSchema.KeyColumn;
+    return Schema;
+}
 
-    return ValidType.Contains(InStr);
+bool XlsxManager::CheckIsDataTypeCell(std::string_view InStr)
+{
+    return SheetCsvConverter::IsDataTypeToken(InStr);
 }
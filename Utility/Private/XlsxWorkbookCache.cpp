@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "XlsxWorkbookCache.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+
+using namespace std;
+
+namespace
+{
+    struct FCachedWorkbook
+    {
+        XlsxWorkbookCache::FReaderPtr Reader;
+        FDateTime TimeStamp;
+        int64 FileSize = 0;
+        uint64 LastUse = 0;
+    };
+
+    FCriticalSection CacheLock;
+    TMap<FString, FCachedWorkbook> CachedWorkbooks;
+    uint64 UseCounter = 0;
+    int64 MemoryBudget = 256 * 1024 * 1024;
+
+    FXlsxWorkbookCacheStats Stats;
+}
+
+static FAutoConsoleCommand WorkbookCacheStatsCommand(
+    TEXT("DataTable.WorkbookCacheStats"),
+    TEXT("Logs hit / miss counters of the shared Xlsx workbook cache"),
+    FConsoleCommandDelegate::CreateLambda([]()
+    {
+        const FXlsxWorkbookCacheStats CacheStats = XlsxWorkbookCache::GetStats();
+        UE_LOG(LogTemp, Display, TEXT("Workbook cache : %lld hits, %lld misses, %lld evictions, %d workbooks, %lld KB of %lld KB"),
+            CacheStats.Hits, CacheStats.Misses, CacheStats.Evictions, CacheStats.CachedWorkbooks, CacheStats.CachedBytes / 1024, XlsxWorkbookCache::GetMemoryBudget() / 1024);
+    }));
+
+XlsxWorkbookCache::XlsxWorkbookCache()
+{
+}
+
+XlsxWorkbookCache::~XlsxWorkbookCache()
+{
+}
+
+XlsxWorkbookCache::FReaderPtr XlsxWorkbookCache::Acquire(const FString& InXlsxFilePath, FString* OutError)
+{
+    const FString Key = FPaths::ConvertRelativePathToFull(InXlsxFilePath);
+
+    const FDateTime TimeStamp = IFileManager::Get().GetTimeStamp(*Key);
+    const int64 FileSize = IFileManager::Get().FileSize(*Key);
+    if (FileSize < 0)
+    {
+        if (OutError != nullptr)
+        {
+            *OutError = TEXT("Invalid file path for XLSX");
+        }
+        return nullptr;
+    }
+
+    {
+        FScopeLock Lock(&CacheLock);
+
+        FCachedWorkbook* Cached = CachedWorkbooks.Find(Key);
+        if (Cached != nullptr && Cached->TimeStamp == TimeStamp && Cached->FileSize == FileSize)
+        {
+            Cached->LastUse = ++UseCounter;
+            Stats.Hits++;
+            return Cached->Reader;
+        }
+
+        Stats.Misses++;
+    }
+
+    // Opened outside the lock so other workbooks are not held up. Two threads missing on the same
+    // file both open it and the later one replaces the earlier entry, which is harmless.
+    TSharedPtr<XlsxSheetReader, ESPMode::ThreadSafe> Reader = MakeShared<XlsxSheetReader, ESPMode::ThreadSafe>();
+    if (Reader->Open(filesystem::path(*Key)) == false)
+    {
+        if (OutError != nullptr)
+        {
+            *OutError = UTF8_TO_TCHAR(Reader->GetLastError().c_str());
+        }
+        return nullptr;
+    }
+
+    FScopeLock Lock(&CacheLock);
+
+    FCachedWorkbook& Entry = CachedWorkbooks.FindOrAdd(Key);
+    Entry.Reader = Reader;
+    Entry.TimeStamp = TimeStamp;
+    Entry.FileSize = FileSize;
+    Entry.LastUse = ++UseCounter;
+
+    TrimToBudget();
+
+    return Reader;
+}
+
+void XlsxWorkbookCache::TrimToBudget()
+{
+    // Summed here rather than on insert because shared strings load on first read; each reader keeps its own
+    // footprint up to date, so this never waits on a workbook that is still loading its shared strings
+    int64 TotalBytes = 0;
+    for (const TPair<FString, FCachedWorkbook>& Pair : CachedWorkbooks)
+    {
+        TotalBytes += static_cast<int64>(Pair.Value.Reader->GetMemoryFootprint());
+    }
+
+    // The most recently used workbook is always kept, even if it alone is over budget
+    while (TotalBytes > MemoryBudget && CachedWorkbooks.Num() > 1)
+    {
+        const FString* OldestKey = nullptr;
+        uint64 OldestUse = MAX_uint64;
+        for (const TPair<FString, FCachedWorkbook>& Pair : CachedWorkbooks)
+        {
+            if (Pair.Value.LastUse < OldestUse)
+            {
+                OldestUse = Pair.Value.LastUse;
+                OldestKey = &Pair.Key;
+            }
+        }
+
+        const FString EvictKey = *OldestKey;
+        TotalBytes -= static_cast<int64>(CachedWorkbooks[EvictKey].Reader->GetMemoryFootprint());
+        CachedWorkbooks.Remove(EvictKey);
+        Stats.Evictions++;
+    }
+
+    Stats.CachedWorkbooks = CachedWorkbooks.Num();
+    Stats.CachedBytes = TotalBytes;
+}
+
+void XlsxWorkbookCache::SetMemoryBudget(int64 InBytes)
+{
+    FScopeLock Lock(&CacheLock);
+    MemoryBudget = FMath::Max<int64>(InBytes, 0);
+    TrimToBudget();
+}
+
+int64 XlsxWorkbookCache::GetMemoryBudget()
+{
+    FScopeLock Lock(&CacheLock);
+    return MemoryBudget;
+}
+
+FXlsxWorkbookCacheStats XlsxWorkbookCache::GetStats()
+{
+    FScopeLock Lock(&CacheLock);
+    return Stats;
+}
+
+void XlsxWorkbookCache::ResetStats()
+{
+    FScopeLock Lock(&CacheLock);
+    Stats.Hits = 0;
+    Stats.Misses = 0;
+    Stats.Evictions = 0;
+}
+
+void XlsxWorkbookCache::Clear()
+{
+    FScopeLock Lock(&CacheLock);
+    CachedWorkbooks.Empty();
+    Stats.CachedWorkbooks = 0;
+    Stats.CachedBytes = 0;
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Measures the Xlsx -> CSV conversion paths against each other.
+ * Console : DataTable.BenchmarkCSV <XlsxFilePath> <OutFolderPath>
+ *           DataTable.BenchmarkSuite <OutFolderPath> [MaxRows]
+ */
+class DATATABLEMODULE_API ConversionBenchmark
+{
+public:
+    // Converts every sheet with the OpenXLSX DOM path and the streaming path, logs rows/sec and checks the outputs match
+    static bool CompareSheetReaders(const FString& InXlsxFilePath, const FString& OutFolderPath);
+
+    // Generates synthetic workbooks (rows, columns, string / number mix, shared string cardinality, sheet count)
+    // and times CSV conversion, struct generation, DataTable import from CSV and straight from the workbook on each,
+    // through reflection and through a row decoder.
+    // Results go to BenchmarkResults.json.
+    static bool RunSuite(const FString& OutFolderPath, int32 InMaxRows);
+
+private:
+    ConversionBenchmark();
+    ~ConversionBenchmark();
+};
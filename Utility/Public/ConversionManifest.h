@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#define CSV_MANIFEST_FILENAME "CSVManifest.json"
+
+// Bump whenever the CSV produced for the same sheet would change, so every sheet is converted again
+#define CSV_CONVERTER_VERSION 3
+
+// Header rows of a converted sheet, enough to generate its row struct without reading the CSV
+struct FSheetSchema
+{
+	// Without the leading "Key" column of the CSV
+	TArray<FString> Types;
+	TArray<FString> Names;
+
+	// Index in Types / Names of the KEY column, INDEX_NONE when rows are numbered or it is not known
+	int32 KeyColumn = INDEX_NONE;
+
+	bool IsValid() const { return Names.Num() > 0 && Names.Num() == Types.Num(); }
+};
+
+// Inputs and output of one sheet -> CSV conversion
+struct FConversionRecord
+{
+	FString WorkbookPath;
+	FDateTime WorkbookTimeStamp;
+	int64 WorkbookSize = 0;
+
+	// CRC32 of the sheet XML and the shared string table, straight from the zip central directory
+	uint32 SheetCrc = 0;
+	uint32 SharedStringsCrc = 0;
+
+	int32 ConverterVersion = 0;
+
+	// zlib CRC32, as computed by CsvFileWriter
+	uint32 OutputCrc = 0;
+	int64 OutputSize = 0;
+	FDateTime OutputTimeStamp;
+
+	// Invalid in manifests written before schemas were recorded
+	FSheetSchema Schema;
+};
+
+/**
+ * Per-sheet record of the last conversion into a CSV folder, stored in that folder as CSV_MANIFEST_FILENAME.
+ * A sheet is up to date when its zip entries, the converter version and the CSV on disk are all unchanged,
+ * so a workbook that was only re-saved is not converted again.
+ */
+class DATATABLEMODULE_API ConversionManifest
+{
+public:
+	// Keyed by sheet name, which is also the CSV file name. A missing or unreadable manifest is empty.
+	static void Load(const FString& InCSVFolderPath, TMap<FString, FConversionRecord>& OutRecords);
+
+	// Merges into the manifest on disk, so conversions of different workbooks into one folder do not drop each other's records.
+	// The merge is locked within this process only; one CSV folder should not be converted by two processes at once.
+	static bool Update(const FString& InCSVFolderPath, const TMap<FString, FConversionRecord>& InRecords);
+
+	// InCurrent has the workbook fields filled; the CSV is checked against the recorded output
+	static bool IsUpToDate(const FConversionRecord& InRecorded, const FConversionRecord& InCurrent, const FString& InCSVFilePath);
+
+	// The recorded schema, only if the CSV on disk is still the recorded output. Checks size and timestamp, never reads the CSV.
+	static bool FindSchema(const FConversionRecord& InRecorded, const FString& InCSVFilePath, FSheetSchema& OutSchema);
+
+private:
+	ConversionManifest();
+	~ConversionManifest();
+};
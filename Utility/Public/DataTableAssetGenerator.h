@@ -7,14 +7,63 @@
 #include "Windows/AllowWindowsPlatformTypes.h"
 
 #include "OpenXLSX.hpp"
+
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
 #include <algorithm>
 
-#include "Windows/HideWindowsPlatformTypes.h"
-#endif
+#include "SheetTableReader.h"
+#include "SheetCache.h"
+
+class UDataTable;
+
+// What an import changed in the asset. Rows are matched by name and compared as whole structs after import.
+struct FDataTableUpdateStats
+{
+	int32 AddedRows = 0;
+	int32 ChangedRows = 0;
+	int32 RemovedRows = 0;
+	int32 UnchangedRows = 0;
+	// Tables whose rows were put back in sheet order
+	int32 ReorderedTables = 0;
+
+	bool HasChanges() const { return AddedRows + ChangedRows + RemovedRows + ReorderedTables > 0; }
+
+	FDataTableUpdateStats& operator+=(const FDataTableUpdateStats& InOther)
+	{
+		AddedRows += InOther.AddedRows;
+		ChangedRows += InOther.ChangedRows;
+		RemovedRows += InOther.RemovedRows;
+		UnchangedRows += InOther.UnchangedRows;
+		ReorderedTables += InOther.ReorderedTables;
+		return *this;
+	}
+};
+
+// One table read by LoadForImport on any thread, turned into an asset by CreateDataTable on the game thread
+struct FDataTableImportData
+{
+	enum class ESource : uint8
+	{
+		None,
+		CSV,
+		Sheet,
+		SheetCache,
+	};
+
+	ESource Source = ESource::None;
+
+	// Only the member matching Source is filled
+	FString CSVStr;
+	SheetTable Sheet;
+	SheetCache Cache;
+};
+
 /**
  * 
  */
@@ -22,7 +71,52 @@ class DATATABLEMODULE_API DataTableAssetGanerator
 {
 public:
 	static bool CreateDataTableFromCSV(const FString& InAssetName, const FString& InCSVFilePath, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj);
+
+	// Reads InSheetName from InXlsxFilePath when it is set, otherwise the SheetCache written with InCSVFilePath if it is current, otherwise the CSV.
+	// InbRowDecoder tells that the row struct has a registered FDataTableRowDecoder : the CSV is then split into OutData.Sheet, see LoadCSVTableForImport.
+	// Decided by the caller because the struct may only be looked at on the game thread.
+	static bool LoadForImport(const FString& InCSVFilePath, const FString& InXlsxFilePath, const FString& InSheetName, FDataTableImportData& OutData, FString* OutError = nullptr, bool InbRowDecoder = false);
+	static bool CreateDataTable(const FString& InAssetName, const FDataTableImportData& InData, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj);
+
+	// CreateDataTable split for batches, game thread only : build every table first, then save them together.
+	// BuildDataTable creates or updates the asset, only dirtying its package when a row changed; nullptr on failure.
+	static UDataTable* BuildDataTable(const FString& InAssetName, const FDataTableImportData& InData, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj, FDataTableUpdateStats* OutStats = nullptr);
+	// The Fill* matching InData.Source, on a table that is already created
+	static bool FillDataTable(UDataTable* InDataTable, const FDataTableImportData& InData, TArray<FString>& OutProblems, FDataTableUpdateStats* OutStats = nullptr);
+	// Saves the dirty ones, with one asset registry update for the whole batch; concurrent with DataTable.ConcurrentSave. Returns true if all were saved.
+	static bool SaveDataTables(const TArray<UDataTable*>& InDataTables, TArray<UDataTable*>* OutFailedTables = nullptr);
+
+	// File part of the import, safe on any thread : loads the CSV and drops the type row
+	static bool LoadCSVForImport(const FString& InCSVFilePath, FString& OutCSVStr);
+	// Same, for structs with a decoder : splits the UTF-8 lines straight into a table without an FString copy.
+	// False for UTF-16 or quoted CSVs, which go through LoadCSVForImport and the engine's parser.
+	static bool LoadCSVTableForImport(const FString& InCSVFilePath, SheetTable& OutTable);
+	// UObject part of the import, game thread only : creates or updates the asset and saves its package
+	static bool CreateDataTableFromCSVString(const FString& InAssetName, const FString& InCSVStr, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj);
+	// Updates the rows of InDataTable, whose RowStruct must be set : the imported rows are staged in a transient table and replace the asset's
+	// in one rebuild with a single change notification, an asset whose rows are all unchanged is left untouched.
+	// The CSV string goes through the engine's parser; the other Fill* use the row struct's generated FDataTableRowDecoder when one is registered.
+	static bool FillDataTableFromCSVString(UDataTable* InDataTable, const FString& InCSVStr, TArray<FString>& OutProblems, FDataTableUpdateStats* OutStats = nullptr);
+
+	// Direct import without a CSV. File part, safe on any thread : reads the sheet's table straight from the workbook
+	static bool LoadSheetForImport(const FString& InXlsxFilePath, const FString& InSheetName, SheetTable& OutTable, FString* OutError = nullptr);
+	// UObject part of the direct import, game thread only : cell text is imported into the row struct's properties
+	static bool CreateDataTableFromSheet(const FString& InAssetName, const SheetTable& InTable, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj);
+	// Same row update as FillDataTableFromCSVString, without the CSV text
+	static bool FillDataTableFromSheet(UDataTable* InDataTable, const SheetTable& InTable, TArray<FString>& OutProblems, FDataTableUpdateStats* OutStats = nullptr);
+
+	// Import from the SheetCache written next to a CSV. File part, safe on any thread : maps the cache
+	static bool LoadSheetCacheForImport(const FString& InSheetCachePath, SheetCache& OutCache, FString* OutError = nullptr);
+	// UObject part, game thread only : numeric columns are set without going through text
+	static bool CreateDataTableFromSheetCache(const FString& InAssetName, const SheetCache& InCache, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj);
+	static bool FillDataTableFromSheetCache(UDataTable* InDataTable, const SheetCache& InCache, TArray<FString>& OutProblems, FDataTableUpdateStats* OutStats = nullptr);
 private:
 	DataTableAssetGanerator();
 	~DataTableAssetGanerator();
+
+	// Existing asset at the package path or a new one using InStructObj
+	static UDataTable* FindOrCreateDataTable(const FString& InAssetName, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj);
+	// Finds or creates the asset, fills it with InFill and logs its problems
+	static UDataTable* BuildDataTableWith(const FString& InAssetName, const FString& InAssetFolderPath, TWeakObjectPtr<UScriptStruct> InStructObj,
+		TFunctionRef<bool(UDataTable*, TArray<FString>&, FDataTableUpdateStats&)> InFill, FDataTableUpdateStats* OutStats = nullptr);
 };
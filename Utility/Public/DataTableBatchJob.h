@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Containers/Ticker.h"
+#include "DataTableAssetGenerator.h"
+
+#include <atomic>
+
+enum class EBatchJobType : uint8
+{
+	ConvertCSV,
+	GenerateStruct,
+	ImportDataTable,
+};
+
+struct FBatchJobProgress
+{
+	FString ExcelName;
+	FString SheetName;
+	bool bSuccess = false;
+	bool bUpToDate = false;
+	FString Error;
+	int32 CompletedCount = 0;
+	int32 TotalCount = 0;
+};
+
+struct FBatchJobSummary
+{
+	EBatchJobType Type = EBatchJobType::ConvertCSV;
+	int32 SucceededCount = 0;
+	// Included in SucceededCount
+	int32 UpToDateCount = 0;
+	TArray<FString> Failures;
+	bool bCancelled = false;
+	double Seconds = 0.0;
+
+	// Import only : game thread time spent filling tables, and saving their packages in one batch at the end
+	double BuildSeconds = 0.0;
+	double SaveSeconds = 0.0;
+
+	// Import only : rows changed in the assets, summed over every table
+	FDataTableUpdateStats RowStats;
+};
+
+struct FDataTableImportItem
+{
+	FString AssetName;
+	FString CSVFilePath;
+	TWeakObjectPtr<UScriptStruct> StructObj;
+
+	// When set, the sheet named AssetName is read straight from this workbook and CSVFilePath is not used
+	FString ExcelFilePath;
+};
+
+DECLARE_DELEGATE_OneParam(FOnBatchJobProgress, const FBatchJobProgress&);
+DECLARE_DELEGATE_OneParam(FOnBatchJobCompleted, const FBatchJobSummary&);
+
+/**
+ * One CSV / Struct / DataTable batch started from the manager tab.
+ * File work runs on worker threads, across several workbooks at once; only UObject and package work
+ * runs on the game thread, within a small time budget per tick. Delegates are always executed on the game thread.
+ */
+class DATATABLEMODULE_API DataTableBatchJob : public TSharedFromThis<DataTableBatchJob, ESPMode::ThreadSafe>
+{
+public:
+	static TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> ConvertCSV(const TMap<FString, TArray<FString>>& InSheetMap, const FString& InCSVFolderPath, bool InbForceRebuild, bool InbWriteSheetCache, FOnBatchJobProgress InOnProgress, FOnBatchJobCompleted InOnCompleted);
+	static TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> GenerateStruct(const TArray<FString>& InExcelFiles, const FString& InCSVFolderPath, const FString& InStructFolderPath, bool InbHeaderPerSheet, FOnBatchJobProgress InOnProgress, FOnBatchJobCompleted InOnCompleted);
+	static TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> ImportDataTable(const TArray<FDataTableImportItem>& InItems, const FString& InAssetFolderPath, FOnBatchJobProgress InOnProgress, FOnBatchJobCompleted InOnCompleted);
+
+	~DataTableBatchJob();
+
+	// Work already started finishes, everything else is skipped
+	void Cancel();
+
+	bool IsCancelled() const { return bCancelRequested.load(); }
+	bool IsFinished() const { return bFinished.load(); }
+	EBatchJobType GetType() const { return Type; }
+
+private:
+	DataTableBatchJob(EBatchJobType InType, int32 InTotalCount, FOnBatchJobProgress InOnProgress, FOnBatchJobCompleted InOnCompleted);
+
+	// Both are safe to call from any thread
+	void ReportProgress(FBatchJobProgress InProgress);
+	void Complete();
+
+	void RunImport(const TArray<FDataTableImportItem>& InItems, const FString& InAssetFolderPath);
+	bool TickImport(float InDeltaTime);
+	void SaveBuiltTables();
+
+private:
+	struct FLoadedTable
+	{
+		FDataTableImportItem Item;
+		FDataTableImportData Data;
+		bool bLoaded = false;
+		FString Error;
+	};
+
+	struct FBuiltTable
+	{
+		TWeakObjectPtr<UDataTable> DataTable;
+		FString ExcelName;
+		FString SheetName;
+	};
+
+	EBatchJobType Type;
+	int32 TotalCount = 0;
+	double StartTime = 0.0;
+
+	std::atomic<bool> bCancelRequested;
+	std::atomic<bool> bFinished;
+	std::atomic<int32> CompletedCount;
+	std::atomic<bool> bLoadFinished;
+
+	FCriticalSection SummaryLock;
+	FBatchJobSummary Summary;
+
+	// Import only : CSVs loaded by workers, turned into assets on the game thread
+	TQueue<TSharedPtr<FLoadedTable>, EQueueMode::Mpsc> LoadedTables;
+	FString AssetFolderPath;
+	FTSTicker::FDelegateHandle ImportTickerHandle;
+
+	// Import only : tables built on the game thread, saved together once every table is built
+	TArray<FBuiltTable> BuiltTables;
+
+	FOnBatchJobProgress OnProgress;
+	FOnBatchJobCompleted OnCompleted;
+};
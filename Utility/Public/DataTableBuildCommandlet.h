@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DataTableBuildCommandlet.generated.h"
+
+/**
+ * Headless XLSX -> CSV -> Struct -> DataTable build for content builds, without the manager tab.
+ *
+ * UnrealEditor-Cmd <Project>.uproject -run=DataTableBuild [-Excel=<Dir>] [-CSV=<Dir>] [-Struct=<Dir>] [-Asset=<Dir>]
+ *     [-Workers=<N>] [-Force] [-SkipCSV] [-SkipStruct] [-SkipImport] [-Direct] [-SheetCache] [-HeaderPerSheet]
+ *
+ * Paths not given on the command line come from UDataTableManagerConfig. Every stage is incremental unless -Force :
+ * up-to-date sheets are not converted, generated files are only written when their content changed, and assets
+ * newer than their CSV are not imported again. -Direct imports straight from the workbooks instead of the CSVs.
+ * -SheetCache also writes each sheet's SheetCache during conversion; later stages read a current cache instead of its CSV.
+ * -HeaderPerSheet generates <Sheet>.h for every sheet instead of one <Workbook>.h.
+ * Returns 0 when every stage succeeded, 1 otherwise.
+ */
+UCLASS()
+class DATATABLEMODULE_API UDataTableBuildCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDataTableBuildCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <string_view>
+
+// Member types a row decoder parses itself, everything else is imported through reflection
+enum class EDataTableFieldType : uint8
+{
+	Int8,
+	UInt8,
+	Int16,
+	UInt16,
+	Int32,
+	UInt32,
+	Int64,
+	UInt64,
+	Float,
+	Double,
+	Bool,
+	String,
+	Name,
+};
+
+// Only defined for the types above, so a generated field whose member changed type fails to compile
+template<typename T> struct TDataTableFieldType;
+template<> struct TDataTableFieldType<int8> { static constexpr EDataTableFieldType Value = EDataTableFieldType::Int8; };
+template<> struct TDataTableFieldType<uint8> { static constexpr EDataTableFieldType Value = EDataTableFieldType::UInt8; };
+template<> struct TDataTableFieldType<int16> { static constexpr EDataTableFieldType Value = EDataTableFieldType::Int16; };
+template<> struct TDataTableFieldType<uint16> { static constexpr EDataTableFieldType Value = EDataTableFieldType::UInt16; };
+template<> struct TDataTableFieldType<int32> { static constexpr EDataTableFieldType Value = EDataTableFieldType::Int32; };
+template<> struct TDataTableFieldType<uint32> { static constexpr EDataTableFieldType Value = EDataTableFieldType::UInt32; };
+template<> struct TDataTableFieldType<int64> { static constexpr EDataTableFieldType Value = EDataTableFieldType::Int64; };
+template<> struct TDataTableFieldType<uint64> { static constexpr EDataTableFieldType Value = EDataTableFieldType::UInt64; };
+template<> struct TDataTableFieldType<float> { static constexpr EDataTableFieldType Value = EDataTableFieldType::Float; };
+template<> struct TDataTableFieldType<double> { static constexpr EDataTableFieldType Value = EDataTableFieldType::Double; };
+template<> struct TDataTableFieldType<bool> { static constexpr EDataTableFieldType Value = EDataTableFieldType::Bool; };
+template<> struct TDataTableFieldType<FString> { static constexpr EDataTableFieldType Value = EDataTableFieldType::String; };
+template<> struct TDataTableFieldType<FName> { static constexpr EDataTableFieldType Value = EDataTableFieldType::Name; };
+
+struct FDataTableDecoderField
+{
+	// The member's name, which is also its property name
+	const TCHAR* Name;
+	uint32 Offset;
+	EDataTableFieldType Type;
+};
+
+// One entry of a generated field table, offset and type come from the compiled struct
+#define DATATABLE_DECODER_FIELD(StructType, Member) \
+	FDataTableDecoderField{ TEXT(#Member), static_cast<uint32>(STRUCT_OFFSET(StructType, Member)), TDataTableFieldType<decltype(StructType::Member)>::Value }
+
+/**
+ * Parses cell text straight into the members of a row struct, from a field table StructGenerator emits next to the struct.
+ * Only the canonical spelling of each type is handled (plain decimal numbers, true / false / 1 / 0, unquoted text);
+ * DecodeCell returns false for anything else and the importer falls back to FProperty::ImportText for that cell,
+ * so a decoded table holds the same values as a reflected one.
+ */
+class DATATABLEMODULE_API FDataTableRowDecoder
+{
+public:
+	using FGetRowStruct = UScriptStruct* (*)();
+
+	// Generated decoders : the struct is only resolved at import time, after UObject initialization
+	FDataTableRowDecoder(FGetRowStruct InGetRowStruct, uint32 InStructSize, TArrayView<const FDataTableDecoderField> InFields);
+	FDataTableRowDecoder(const UScriptStruct* InRowStruct, TArrayView<const FDataTableDecoderField> InFields);
+
+	const UScriptStruct* GetRowStruct() const;
+	uint32 GetStructSize() const { return StructSize; }
+
+	// Field index of the member behind InPropertyName, INDEX_NONE if it is not decoded
+	int32 FindField(const FName& InPropertyName) const;
+
+	// InText is UTF-8. Returns false when the text is left to reflection, OutRowData is untouched then.
+	bool DecodeCell(int32 InField, std::string_view InText, uint8* OutRowData) const;
+
+private:
+	FGetRowStruct GetRowStructFunc = nullptr;
+	const UScriptStruct* RowStruct = nullptr;
+	uint32 StructSize = 0;
+	TArrayView<const FDataTableDecoderField> Fields;
+};
+
+/**
+ * Decoders of the row structs compiled into the loaded modules. Generated decoders register themselves while their module
+ * is loaded, the importer looks them up by row struct and uses one automatically when it is found.
+ */
+class DATATABLEMODULE_API DataTableRowDecoderRegistry
+{
+public:
+	static void Register(const FDataTableRowDecoder& InDecoder);
+	static void Unregister(const FDataTableRowDecoder& InDecoder);
+
+	// Game thread. nullptr when no decoder is registered for InRowStruct or it was built for a different layout.
+	static const FDataTableRowDecoder* Find(const UScriptStruct* InRowStruct);
+
+private:
+	DataTableRowDecoderRegistry();
+	~DataTableRowDecoderRegistry();
+};
+
+// Registers InDecoder for the lifetime of the object, a static in generated code so it follows module load and unload
+struct FDataTableRowDecoderRegistration
+{
+	explicit FDataTableRowDecoderRegistration(const FDataTableRowDecoder& InDecoder)
+		: Decoder(InDecoder)
+	{
+		DataTableRowDecoderRegistry::Register(Decoder);
+	}
+
+	~FDataTableRowDecoderRegistration()
+	{
+		DataTableRowDecoderRegistry::Unregister(Decoder);
+	}
+
+	FDataTableRowDecoderRegistration(const FDataTableRowDecoderRegistration&) = delete;
+	FDataTableRowDecoderRegistration& operator=(const FDataTableRowDecoderRegistration&) = delete;
+
+private:
+	const FDataTableRowDecoder& Decoder;
+};
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FRowStructIndexStats
+{
+	int32 IndexedStructs = 0;
+	// Full sweeps over every UScriptStruct in memory, once at first use and after each hot reload
+	int32 FullScans = 0;
+	// Modules whose structs were added without a full sweep
+	int32 ModuleScans = 0;
+};
+
+/**
+ * Row structs (FTableRowBase derivatives) compiled into the loaded modules, keyed by struct name.
+ * The index is built on first lookup and then kept current from module notifications : a module loaded later
+ * only has its own /Script package scanned, and a hot reload or Live Coding patch marks the index for one rebuild.
+ * Sheets are matched to the struct carrying their name, so lookups are a hash find instead of a sweep.
+ */
+class DATATABLEMODULE_API RowStructIndex
+{
+public:
+	// Hooks the module and reload notifications, called from module startup and shutdown
+	static void Startup();
+	static void Shutdown();
+
+	// Game thread. nullptr when no loaded row struct is named InStructName, compared case-insensitively like the sheet names.
+	static UScriptStruct* Find(const FString& InStructName);
+
+	static void GetAll(TArray<UScriptStruct*>& OutStructs);
+
+	static FRowStructIndexStats GetStats();
+
+	// Rebuilt on next lookup
+	static void Invalidate();
+
+private:
+	static void EnsureBuilt();
+	static void AddStruct(UScriptStruct* InStruct);
+	static void AddModuleStructs(FName InModuleName);
+
+private:
+	RowStructIndex();
+	~RowStructIndex();
+};
@@ -7,28 +7,79 @@
 #include "Windows/AllowWindowsPlatformTypes.h"
 
 #include "OpenXLSX.hpp"
+
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
 
-#include "Windows/HideWindowsPlatformTypes.h"
-#endif
+#include "ConversionManifest.h"
+
+struct FStructGenerateOptions
+{
+	// <Sheet>.h per sheet instead of one <Workbook>.h, so a schema edit only recompiles the code using that struct
+	bool bHeaderPerSheet = false;
+
+	// Keyed by sheet name, typically the results of a conversion that just ran
+	const TMap<FString, FSheetSchema>* Schemas = nullptr;
+};
+
+struct FStructGenerateStats
+{
+	int32 WrittenFiles = 0;
+	// Generated in memory and identical to the file on disk, which keeps its timestamp
+	int32 UnchangedFiles = 0;
+	// Left over from the other header layout
+	int32 RemovedFiles = 0;
+
+	bool HasChanges() const { return WrittenFiles + RemovedFiles > 0; }
+};
+
 /**
- * 
+ * Writes USTRUCT headers for a workbook's sheets, plus a source file with their row decoders. Only the header rows
+ * are used : they come from the schemas passed in, the CSV folder manifest or the first two lines of each CSV,
+ * so the cost does not depend on the row count. Files are generated in memory and only written when their content
+ * changed, so an unchanged schema does not invalidate UHT output or anything that includes the header.
  */
 class DATATABLEMODULE_API StructGenerator
 {
 public:
-	static bool GenerateStructFromXlsx(const FString& InXlsxFilePath, const FString& InCSVFolderPath, const FString& OutStructFolderPath);
+	static bool GenerateStructFromXlsx(const FString& InXlsxFilePath, const FString& InCSVFolderPath, const FString& OutStructFolderPath,
+		const FStructGenerateOptions& InOptions = FStructGenerateOptions(), FStructGenerateStats* OutStats = nullptr);
+
+	static bool WriteBasicInformation(std::ostream& InOpenedFile);
+	// Follows the banner : the workbook a generated file belongs to, the only one allowed to replace or remove it
+	static bool WriteSourceWorkbook(std::ostream& InOpenedFile, const std::string& InWorkbookName);
+	static bool WriteInclude(std::ostream& InOpenedFile, const std::string& InHeaderName);
+	static bool WriteStruct(std::ostream& InOpenedFile, const std::vector<std::string>& InSheetNames, const TArray<FSheetSchema>& InSchemas);
+	// <HeaderName>RowDecoders.cpp : a field table per struct, registered as its FDataTableRowDecoder in editor builds
+	static bool WriteRowDecoders(std::ostream& InOpenedFile, const std::string& InHeaderName, const std::vector<std::string>& InSheetNames, const TArray<FSheetSchema>& InSchemas);
 
-	static bool WriteBasicInformation(std::ofstream& InOpenedFile);
-	static bool WriteInclude(std::ofstream& InOpenedFile, const std::string& InHeaderName);
-	static bool WriteStruct(std::ofstream& InOpenedFile, OpenXLSX::XLDocument& InOpenedDoc, const FString& InCSVFolderPath);
+	// Leaves the file untouched when it already holds exactly InContent
+	static bool WriteFileIfChanged(const FString& InFilePath, const std::string& InContent, FStructGenerateStats& OutStats);
+
+	// Stops at the first sheet without a readable header, OutSchemas then holds the sheets before it
+	static bool FindSheetSchemas(const std::vector<std::string>& InSheetNames, const FString& InCSVFolderPath, const TMap<FString, FSheetSchema>* InSchemas, TArray<FSheetSchema>& OutSchemas);
+	static bool FindSheetSchema(const FString& InSheetName, const FString& InCSVFilePath, const TMap<FString, FSheetSchema>* InSchemas, const TMap<FString, FConversionRecord>& InRecords, FSheetSchema& OutSchema);
 
 	static FString GetUnrealType(const FString& InVarType);
+	// Types FDataTableRowDecoder parses itself, see EDataTableFieldType
+	static bool IsDecodableType(const FString& InUnrealType);
 private:
+	// Writes <InHeaderName>.h and <InHeaderName>RowDecoders.cpp for the given sheets
+	static bool WriteGeneratedFiles(const FString& OutStructFolderPath, const std::string& InHeaderName, const std::string& InWorkbookName,
+		const std::vector<std::string>& InSheetNames, const TArray<FSheetSchema>& InSchemas, FStructGenerateStats& OutStats);
+	// Deletes the header and decoder source of InHeaderName, only if this generator wrote them for InWorkbookName
+	static void RemoveGeneratedFiles(const FString& OutStructFolderPath, const std::string& InHeaderName, const std::string& InWorkbookName, FStructGenerateStats& OutStats);
+	// True for a file this generator wrote; OutWorkbookName is empty if it was written before owners were recorded
+	static bool ReadGeneratedFileOwner(const FString& InFilePath, std::string& OutWorkbookName);
+
 	StructGenerator();
 	~StructGenerator();
 };
@@ -17,11 +17,75 @@
 #include "Windows/HideWindowsPlatformTypes.h"
 #endif
 
+#include "XlsxSheetReader.h"
+#include "SheetCache.h"
+#include "ConversionManifest.h"
+
+#include <atomic>
+#include <string>
+
 #define TABLE_DIRECTORY "Table"
 #define EXCEL_DIRECTORY "Excel"
 #define CSV_DIRECTORY "CSV"
 #define CSV_EXTENSION ".csv"
 
+struct FCsvConvertStats
+{
+	int32 Rows = 0;
+	int32 DataRows = 0;
+	double Seconds = 0.0;
+
+	// Heap allocations made on the data rows, 0 when no AllocationCounter source is installed
+	uint64 DataRowAllocations = 0;
+
+	// UTF-8 bytes written to the CSV and their zlib CRC32
+	uint64 OutputBytes = 0;
+	uint32 OutputCrc = 0;
+
+	// Header rows of the converted table, also recorded in the manifest
+	FSheetSchema Schema;
+};
+
+struct FSheetConvertResult
+{
+	FString SheetName;
+	bool bSuccess = false;
+
+	// Skipped because the manifest shows the CSV was built from the same sheet data
+	bool bUpToDate = false;
+
+	FString Error;
+	FCsvConvertStats Stats;
+};
+
+struct FXlsxConvertOptions
+{
+	// Sheets of one workbook converted at the same time, 1 converts them in order on the calling thread
+	int32 MaxWorkers = 1;
+
+	// Checked between rows. A cancelled sheet keeps its previous CSV and sheets not started yet are skipped.
+	const std::atomic<bool>* CancelFlag = nullptr;
+
+	// Converts every sheet even if the CSV folder manifest shows it is up to date
+	bool bForceRebuild = false;
+
+	// Also writes each sheet's typed columnar SheetCache next to its CSV, read by import instead of the CSV text
+	bool bWriteSheetCache = false;
+
+	// Called on the converting thread as soon as a sheet is done
+	TFunction<void(const FSheetConvertResult&)> OnSheetCompleted;
+};
+
+struct FXlsxSheetInfo
+{
+	FString SheetName;
+
+	// Used range from the sheet's <dimension>, empty and 0 when not requested or not written by the producer
+	FString Dimension;
+	int32 LastRow = 0;
+	int32 LastColumn = 0;
+};
+
 /**
  * 
  */
@@ -31,12 +95,26 @@ public:
 	XlsxManager();
 	~XlsxManager();
 
-	static bool ConvertAllSheetInXlsx(const FString& InXlsxFilePath, const FString& OutCsvFolderPath);
-	static bool ConvertSpecificSheet(const FString& InXlsxFilePath, const TArray<FString>& InSheetNames, const FString& OutCsvFolderPath);
+	// Every sheet is attempted, a failed sheet does not stop the others. Returns true if all sheets succeeded.
+	static bool ConvertAllSheetInXlsx(const FString& InXlsxFilePath, const FString& OutCsvFolderPath, const FXlsxConvertOptions& InOptions = FXlsxConvertOptions(), TArray<FSheetConvertResult>* OutResults = nullptr);
+	static bool ConvertSpecificSheet(const FString& InXlsxFilePath, const TArray<FString>& InSheetNames, const FString& OutCsvFolderPath, const FXlsxConvertOptions& InOptions = FXlsxConvertOptions(), TArray<FSheetConvertResult>* OutResults = nullptr);
 
 	static void FindAllFilesInFolderPath(TArray<FString>& OutFilesPath, const FString& DirectoryPath, const FString& Extension);
 	static void FindAllSheetInExcelFile(TArray<FString>& SheetNames, const FString& InXlsxFilePath);
+	// Reads only the zip directory and workbook parts, plus the head of each sheet when InbReadDimensions is set.
+	// Shared strings, styles and sheet data are never touched.
+	static bool ProbeWorkbook(const FString& InXlsxFilePath, TArray<FXlsxSheetInfo>& OutSheets, bool InbReadDimensions = false);
 
+#if PLATFORM_WINDOWS
 	static bool CreateCSV(const OpenXLSX::XLWorksheet& InWorksheet, const FString& OutCsvFolderPath);
-	static bool CheckIsDataTypeCell(std::string InStr);
+#endif
+	static bool CreateCSV(const XlsxSheetReader& InReader, const std::string& InSheetName, const FString& OutCsvFolderPath, FCsvConvertStats* OutStats = nullptr, FString* OutError = nullptr, const std::atomic<bool>* InCancelFlag = nullptr, bool InbWriteSheetCache = false);
+	// The SheetCache written with InCSVFilePath, true only if it exists and is not older than the CSV
+	static bool FindSheetCache(const FString& InCSVFilePath, FString& OutSheetCachePath);
+	static FSheetSchema ToSheetSchema(const SheetSchema& InSchema);
+	// Case-insensitive, see DataTypeTokenTable
+	static bool CheckIsDataTypeCell(std::string_view InStr);
+
+private:
+	static bool ConvertSheets(const FString& InXlsxFilePath, const TArray<FString>* InSheetNames, const FString& OutCsvFolderPath, const FXlsxConvertOptions& InOptions, TArray<FSheetConvertResult>* OutResults);
 };
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "XlsxSheetReader.h"
+
+struct FXlsxWorkbookCacheStats
+{
+	int64 Hits = 0;
+	int64 Misses = 0;
+	int64 Evictions = 0;
+	int32 CachedWorkbooks = 0;
+	int64 CachedBytes = 0;
+};
+
+/**
+ * Opened workbooks shared by sheet listing, CSV conversion and struct generation.
+ * An entry is keyed by the file path and only reused while the file keeps the same timestamp and size,
+ * so a workbook saved from Excel is opened again on next use. Least recently used entries are dropped
+ * once the cached readers exceed the memory budget; readers still in use stay alive until released.
+ * Readers do not keep the file open between reads.
+ */
+class DATATABLEMODULE_API XlsxWorkbookCache
+{
+public:
+	using FReaderPtr = TSharedPtr<const XlsxSheetReader, ESPMode::ThreadSafe>;
+
+	// Safe to call from any thread. Returns null and fills OutError if the workbook cannot be opened.
+	static FReaderPtr Acquire(const FString& InXlsxFilePath, FString* OutError = nullptr);
+
+	static void SetMemoryBudget(int64 InBytes);
+	static int64 GetMemoryBudget();
+
+	static FXlsxWorkbookCacheStats GetStats();
+	static void ResetStats();
+	static void Clear();
+
+private:
+	// Drops least recently used entries until the budget is met, caller holds the lock
+	static void TrimToBudget();
+
+private:
+	XlsxWorkbookCache();
+	~XlsxWorkbookCache();
+};
@@ -5,6 +5,8 @@
 #include "HAL/FileManager.h"
 #include "Containers/Map.h"
 #include "Misc/ConfigCacheIni.h"
+#include "DirectoryWatcherModule.h"
+#include "Modules/ModuleManager.h"
 
 #include "FolderPathModifier.h"
 #include "SheetListView.h"
@@ -20,7 +22,6 @@
 #include "Widgets/Views/SHeaderRow.h"
 
 #include "UObject/ObjectMacros.h"
-#include "UObject/UObjectIterator.h"
 #include "Engine/DataTable.h"
 #include "AssetRegistry/AssetRegistryModule.h"
 #include "Engine/UserDefinedStruct.h"
@@ -33,8 +34,6 @@
 
 void SDataTableManager::Construct(const FArguments& InArgs)
 {
-    TryCacheUStructName();
-
     FolderPathModifiers.Add(EPathType::PATH_EXCEL, nullptr);
     FolderPathModifiers.Add(EPathType::PATH_CSV, nullptr);
     FolderPathModifiers.Add(EPathType::PATH_STRUCT, nullptr);
@@ -118,12 +117,94 @@ void SDataTableManager::Construct(const FArguments& InArgs)
                             CreateControlButton("Import CSV to Data table in data table asset folder path", &SDataTableManager::OnImportCSVClicked)
                         ]
 				]
+                + SVerticalBox::Slot()
+                .AutoHeight()
+                .Padding(5)
+                [
+                    SNew(SHorizontalBox)
+                        + SHorizontalBox::Slot()
+                        .AutoWidth()
+                        .VAlign(VAlign_Center)
+                        [
+                            SNew(SButton)
+                                .Text(LOCTEXT("CancelJob", "Cancel"))
+                                .IsEnabled_Lambda([this]() { return IsIdle() == false && RunningJob->IsCancelled() == false; })
+                                .OnClicked(this, &SDataTableManager::OnCancelJobClicked)
+                        ]
+                        + SHorizontalBox::Slot()
+                        .AutoWidth()
+                        .VAlign(VAlign_Center)
+                        .Padding(10, 0, 0, 0)
+                        [
+                            SNew(SCheckBox)
+                                .IsChecked_Lambda([this]() { return bForceRebuildCSV ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+                                .OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bForceRebuildCSV = NewState == ECheckBoxState::Checked; })
+                                [
+                                    SNew(STextBlock)
+                                        .Text(LOCTEXT("ForceRebuildCSV", "Reconvert up-to-date sheets"))
+                                ]
+                        ]
+                        + SHorizontalBox::Slot()
+                        .AutoWidth()
+                        .VAlign(VAlign_Center)
+                        .Padding(10, 0, 0, 0)
+                        [
+                            SNew(SCheckBox)
+                                .IsChecked_Lambda([this]() { return bImportFromExcel ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+                                .OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bImportFromExcel = NewState == ECheckBoxState::Checked; })
+                                [
+                                    SNew(STextBlock)
+                                        .Text(LOCTEXT("ImportFromExcel", "Import from Excel directly"))
+                                        .ToolTipText(LOCTEXT("ImportFromExcelTooltip", "Read the checked sheets straight from their workbooks when importing, without going through CSV files"))
+                                ]
+                        ]
+                        + SHorizontalBox::Slot()
+                        .AutoWidth()
+                        .VAlign(VAlign_Center)
+                        .Padding(10, 0, 0, 0)
+                        [
+                            SNew(SCheckBox)
+                                .IsChecked_Lambda([this]() { return bWriteSheetCache ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+                                .OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bWriteSheetCache = NewState == ECheckBoxState::Checked; })
+                                [
+                                    SNew(STextBlock)
+                                        .Text(LOCTEXT("WriteSheetCache", "Write sheet cache"))
+                                        .ToolTipText(LOCTEXT("WriteSheetCacheTooltip", "Also write a typed binary copy of each sheet next to its CSV, read by import instead of the CSV text"))
+                                ]
+                        ]
+                        + SHorizontalBox::Slot()
+                        .AutoWidth()
+                        .VAlign(VAlign_Center)
+                        .Padding(10, 0, 0, 0)
+                        [
+                            SNew(SCheckBox)
+                                .IsChecked_Lambda([this]() { return bHeaderPerSheet ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+                                .OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bHeaderPerSheet = NewState == ECheckBoxState::Checked; })
+                                [
+                                    SNew(STextBlock)
+                                        .Text(LOCTEXT("HeaderPerSheet", "One header per sheet"))
+                                        .ToolTipText(LOCTEXT("HeaderPerSheetTooltip", "Generate <Sheet>.h for every sheet instead of one header per workbook, so editing a sheet only recompiles the code using its struct"))
+                                ]
+                        ]
+                        + SHorizontalBox::Slot()
+                        .FillWidth(1.f)
+                        .VAlign(VAlign_Center)
+                        .Padding(10, 0, 0, 0)
+                        [
+                            SAssignNew(JobStatusText, STextBlock)
+                        ]
+                ]
         ];
 
     TryCacheExcelFiles();
     TryCacheCSVFiles();
-    SheetListView->RefreshSheetState(ExcelFiles, CSVFiles, UStructObjs);
-    SheetListView->RefreshCSVState(CSVFiles);
+    SheetListView->RefreshSheetState(ExcelFiles, CSVFiles);
+}
+
+SDataTableManager::~SDataTableManager()
+{
+    UnwatchFolder(EPathType::PATH_EXCEL);
+    UnwatchFolder(EPathType::PATH_CSV);
 }
 
 void SDataTableManager::OnCSVFolderPathTextChanged(const FText& NewText)
@@ -134,41 +215,275 @@ void SDataTableManager::OnCSVFolderPathTextChanged(const FText& NewText)
 
 void SDataTableManager::OnExcelFolderPathTextChanged(const FText& NewText)
 {
+    // The CSV folder did not change, its files are kept current by its watcher
     TryCacheExcelFiles();
-    TryCacheCSVFiles();
-    SheetListView->RefreshSheetState(ExcelFiles, CSVFiles, UStructObjs);
-    SheetListView->RefreshCSVState(CSVFiles);
+    SheetListView->RefreshSheetState(ExcelFiles, CSVFiles);
+}
+
+void SDataTableManager::TryCacheCSVFiles()
+{
+    const FString& FolderPath = *FolderPathModifiers[EPathType::PATH_CSV]->GetPathPtrOnType();
+
+    TArray<FString> CSVFilePaths;
+    XlsxManager::FindAllFilesInFolderPath(CSVFilePaths, FolderPath, ".csv");
+
+    SSheetListView::IndexCSVFiles(CSVFilePaths, CSVFiles);
+
+    WatchFolder(EPathType::PATH_CSV, FolderPath, IDirectoryWatcher::FDirectoryChanged::CreateSP(this, &SDataTableManager::OnCSVFolderChanged));
+}
+
+void SDataTableManager::TryCacheExcelFiles()
+{
+    const FString& FolderPath = *FolderPathModifiers[EPathType::PATH_EXCEL]->GetPathPtrOnType();
+
+    ExcelFiles.Empty();
+
+    XlsxManager::FindAllFilesInFolderPath(ExcelFiles, FolderPath, ".xlsx");
+
+    WatchFolder(EPathType::PATH_EXCEL, FolderPath, IDirectoryWatcher::FDirectoryChanged::CreateSP(this, &SDataTableManager::OnExcelFolderChanged));
 }
 
-void SDataTableManager::TryCacheUStructName()
+void SDataTableManager::WatchFolder(EPathType InPathType, const FString& InFolderPath, IDirectoryWatcher::FDirectoryChanged InCallback)
 {
-    UStructObjs.Empty();
+    const FFolderWatch* CurrentWatch = FolderWatches.Find(InPathType);
+    if (CurrentWatch != nullptr && CurrentWatch->FolderPath == InFolderPath)
+    {
+        return;
+    }
+
+    UnwatchFolder(InPathType);
+
+    if (InFolderPath.IsEmpty() || FPaths::DirectoryExists(InFolderPath) == false)
+    {
+        return;
+    }
+
+    IDirectoryWatcher* DirectoryWatcher = FModuleManager::LoadModuleChecked<FDirectoryWatcherModule>(TEXT("DirectoryWatcher")).Get();
+    if (DirectoryWatcher == nullptr)
+    {
+        return;
+    }
+
+    FFolderWatch Watch;
+    Watch.FolderPath = InFolderPath;
+    if (DirectoryWatcher->RegisterDirectoryChangedCallback_Handle(InFolderPath, MoveTemp(InCallback), Watch.Handle, IDirectoryWatcher::WatchOptions::IncludeDirectoryChanges))
+    {
+        FolderWatches.Add(InPathType, MoveTemp(Watch));
+    }
+    else
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Failed to watch %s, the sheet list updates on folder change only"), *InFolderPath);
+    }
+}
+
+void SDataTableManager::UnwatchFolder(EPathType InPathType)
+{
+    FFolderWatch Watch;
+    if (FolderWatches.RemoveAndCopyValue(InPathType, Watch) == false)
+    {
+        return;
+    }
+
+    // Already gone when the editor shuts down before the tab
+    FDirectoryWatcherModule* DirectoryWatcherModule = FModuleManager::GetModulePtr<FDirectoryWatcherModule>(TEXT("DirectoryWatcher"));
+    if (DirectoryWatcherModule != nullptr && DirectoryWatcherModule->Get() != nullptr)
+    {
+        DirectoryWatcherModule->Get()->UnregisterDirectoryChangedCallback_Handle(Watch.FolderPath, Watch.Handle);
+    }
+}
+
+// Last action per path, a file saved through a temporary copy reports several. False when the watcher lost events.
+static bool CollectChangedPaths(const TArray<FFileChangeData>& InChanges, TMap<FString, FFileChangeData::EFileChangeAction>& OutPaths)
+{
+    for (const FFileChangeData& Change : InChanges)
+    {
+        if (Change.Action == FFileChangeData::FCA_RescanRequired)
+        {
+            return false;
+        }
+
+        FString Path = Change.Filename;
+        FPaths::NormalizeFilename(Path);
+        OutPaths.Add(MoveTemp(Path), Change.Action);
+    }
+    return true;
+}
+
+void SDataTableManager::OnExcelFolderChanged(const TArray<FFileChangeData>& InChanges)
+{
+    TMap<FString, FFileChangeData::EFileChangeAction> ChangedPaths;
+    if (CollectChangedPaths(InChanges, ChangedPaths) == false)
+    {
+        TryCacheExcelFiles();
+        SheetListView->RefreshSheetState(ExcelFiles, CSVFiles);
+        return;
+    }
 
-    for (TObjectIterator<UScriptStruct> It; It; ++It)
+    for (const TPair<FString, FFileChangeData::EFileChangeAction>& Pair : ChangedPaths)
     {
-        UScriptStruct* Struct = *It;
-        if (Struct->IsChildOf(FTableRowBase::StaticStruct()))
+        if (FPaths::DirectoryExists(Pair.Key))
         {
-            if (Struct != FTableRowBase::StaticStruct())
+            // A folder moved or copied in, only its own files are listed
+            if (Pair.Value == FFileChangeData::FCA_Added)
             {
-                UStructObjs.Add(Struct);
+                TArray<FString> AddedFiles;
+                XlsxManager::FindAllFilesInFolderPath(AddedFiles, Pair.Key, ".xlsx");
+                for (const FString& AddedFile : AddedFiles)
+                {
+                    OnExcelFileChanged(AddedFile);
+                }
             }
+            continue;
         }
+
+        if (Pair.Value == FFileChangeData::FCA_Removed && FPaths::GetExtension(Pair.Key).IsEmpty())
+        {
+            // A removed folder takes its workbooks with it
+            const FString Prefix = Pair.Key / TEXT("");
+            for (int32 Index = ExcelFiles.Num() - 1; Index >= 0; Index--)
+            {
+                if (ExcelFiles[Index].StartsWith(Prefix))
+                {
+                    SheetListView->RemoveWorkbook(ExcelFiles[Index]);
+                    ExcelFiles.RemoveAt(Index);
+                }
+            }
+            continue;
+        }
+
+        OnExcelFileChanged(Pair.Key);
     }
 }
 
-void SDataTableManager::TryCacheCSVFiles()
+void SDataTableManager::OnCSVFolderChanged(const TArray<FFileChangeData>& InChanges)
+{
+    TMap<FString, FFileChangeData::EFileChangeAction> ChangedPaths;
+    if (CollectChangedPaths(InChanges, ChangedPaths) == false)
+    {
+        TryCacheCSVFiles();
+        SheetListView->RefreshCSVState(CSVFiles);
+        return;
+    }
+
+    for (const TPair<FString, FFileChangeData::EFileChangeAction>& Pair : ChangedPaths)
+    {
+        if (FPaths::DirectoryExists(Pair.Key))
+        {
+            if (Pair.Value == FFileChangeData::FCA_Added)
+            {
+                TArray<FString> AddedFiles;
+                XlsxManager::FindAllFilesInFolderPath(AddedFiles, Pair.Key, ".csv");
+                for (const FString& AddedFile : AddedFiles)
+                {
+                    OnCSVFileChanged(AddedFile);
+                }
+            }
+            continue;
+        }
+
+        if (Pair.Value == FFileChangeData::FCA_Removed && FPaths::GetExtension(Pair.Key).IsEmpty())
+        {
+            // Sheets whose CSV was in the removed folder may still have one elsewhere
+            const FString Prefix = Pair.Key / TEXT("");
+            TArray<FString> AffectedSheets;
+            for (const TPair<FString, FString>& CSVFile : CSVFiles)
+            {
+                if (CSVFile.Value.StartsWith(Prefix))
+                {
+                    AffectedSheets.Add(CSVFile.Key);
+                }
+            }
+            if (AffectedSheets.Num() > 0)
+            {
+                ResolveCSVFiles(AffectedSheets);
+            }
+            continue;
+        }
+
+        OnCSVFileChanged(Pair.Key);
+    }
+}
+
+void SDataTableManager::OnExcelFileChanged(const FString& InExcelFile)
 {
-    CSVFiles.Empty();
+    // Excel keeps a "~$<Workbook>.xlsx" lock file next to every open workbook
+    if (FPaths::GetExtension(InExcelFile, true) != TEXT(".xlsx") || FPaths::GetCleanFilename(InExcelFile).StartsWith(TEXT("~$")))
+    {
+        return;
+    }
 
-    XlsxManager::FindAllFilesInFolderPath(CSVFiles, *FolderPathModifiers[EPathType::PATH_CSV]->GetPathPtrOnType(), ".csv");
+    const int32 Index = ExcelFiles.IndexOfByKey(InExcelFile);
+    if (FPaths::FileExists(InExcelFile))
+    {
+        // Added, or saved with sheets possibly added, renamed or removed
+        if (Index == INDEX_NONE)
+        {
+            ExcelFiles.Add(InExcelFile);
+        }
+        SheetListView->RefreshWorkbook(InExcelFile);
+    }
+    else if (Index != INDEX_NONE)
+    {
+        ExcelFiles.RemoveAt(Index);
+        SheetListView->RemoveWorkbook(InExcelFile);
+    }
 }
 
-void SDataTableManager::TryCacheExcelFiles()
+void SDataTableManager::ResolveCSVFiles(const TArray<FString>& InSheetNames)
 {
-    ExcelFiles.Empty();
+    // Searched again so the first file found wins, as in IndexCSVFiles
+    TArray<FString> CSVFilePaths;
+    XlsxManager::FindAllFilesInFolderPath(CSVFilePaths, *FolderPathModifiers[EPathType::PATH_CSV]->GetPathPtrOnType(), ".csv");
+
+    for (const FString& SheetName : InSheetNames)
+    {
+        const FString* FirstFile = CSVFilePaths.FindByPredicate([&SheetName](const FString& CSVFilePath) { return FPaths::GetBaseFilename(CSVFilePath) == SheetName; });
+        const FString* IndexedFile = CSVFiles.Find(SheetName);
+        if (FirstFile == nullptr)
+        {
+            if (IndexedFile != nullptr)
+            {
+                CSVFiles.Remove(SheetName);
+                SheetListView->SetCSVFile(SheetName, FString());
+            }
+        }
+        else if (IndexedFile == nullptr || *IndexedFile != *FirstFile)
+        {
+            CSVFiles.Add(SheetName, *FirstFile);
+            SheetListView->SetCSVFile(SheetName, *FirstFile);
+        }
+    }
+}
+
+void SDataTableManager::OnCSVFileChanged(const FString& InCSVFile)
+{
+    if (FPaths::GetExtension(InCSVFile, true) != TEXT(".csv"))
+    {
+        return;
+    }
+
+    // A modified CSV keeps its path, only adds and removes change what the rows show
+    const FString SheetName = FPaths::GetBaseFilename(InCSVFile);
+    const FString* IndexedFile = CSVFiles.Find(SheetName);
+    const bool bExists = FPaths::FileExists(InCSVFile);
+    if (IndexedFile == nullptr)
+    {
+        if (bExists)
+        {
+            CSVFiles.Add(SheetName, InCSVFile);
+            SheetListView->SetCSVFile(SheetName, InCSVFile);
+        }
+        return;
+    }
+
+    // Removing a file that was not the indexed one, or touching the indexed one, leaves the first file as it is
+    if ((*IndexedFile == InCSVFile) == bExists)
+    {
+        return;
+    }
 
-    XlsxManager::FindAllFilesInFolderPath(ExcelFiles, *FolderPathModifiers[EPathType::PATH_EXCEL]->GetPathPtrOnType(), ".xlsx");
+    // Another file of the same name was added, or the indexed one removed : subfolders may hold more than one
+    ResolveCSVFiles({ SheetName });
 }
 
 
@@ -181,6 +496,7 @@ TSharedRef<SWidget> SDataTableManager::CreateControlButton(const FString& InBtnT
         [
             SNew(SButton).VAlign(VAlign_Center).HAlign(HAlign_Center)
                 .Text(FText::FromString(InBtnText))
+                .IsEnabled(this, &SDataTableManager::IsIdle)
                 .OnClicked(this, InFunc)
         ];
 }
@@ -206,22 +522,9 @@ FReply SDataTableManager::OnCSVConverterClicked()
         }
     }
 
-    for (TMap<FString, TArray<FString>>::TConstIterator Iter = SheetMap.CreateConstIterator(); Iter; ++Iter)
-    {
-        const FString& ExcelFullPath = Iter.Key();
-        const TArray<FString>& SheetNames = Iter.Value();
-
-        bool Result = XlsxManager::ConvertSpecificSheet(ExcelFullPath, SheetNames, CSVFolderPath);
-
-        if (Result == false)
-        {
-            FMessageDialog::Open(EAppMsgCategory::Error, EAppMsgType::Ok, LOCTEXT("ErrorMSG_ConvertCSV", "Convert CSV Failed"));
-        }
-    }
-
-    SheetListView->RefreshCSVState(CSVFiles);
-
-    FMessageDialog::Open(EAppMsgCategory::Success, EAppMsgType::Ok, LOCTEXT("SuccessMSG_ConvertCSV", "Convert CSV Success"));
+    StartJob(DataTableBatchJob::ConvertCSV(SheetMap, CSVFolderPath, bForceRebuildCSV, bWriteSheetCache,
+        FOnBatchJobProgress::CreateSP(this, &SDataTableManager::OnJobProgress),
+        FOnBatchJobCompleted::CreateSP(this, &SDataTableManager::OnJobCompleted)));
 
     return FReply::Handled();
 }
@@ -261,26 +564,9 @@ FReply SDataTableManager::OnStructGeneratorClicked()
         }
     }
 
-    bool Result = true;
-
-    for (const FString& ExcelPath : ExcelAry)
-    {
-        Result = StructGenerator::GenerateStructFromXlsx(ExcelPath, CSVFolderPath, StructFolderPath);
-
-        if (Result == false)
-        {
-            break;
-        }
-    }
-
-    if (Result)
-    {
-        FMessageDialog::Open(EAppMsgCategory::Success, EAppMsgType::Ok, LOCTEXT("SuccessMSG_GenerateStruct", "Generate Struct Success\nTo import csv, please rebuild the project"));
-    }
-    else
-    {
-        FMessageDialog::Open(EAppMsgCategory::Error, EAppMsgType::Ok, LOCTEXT("SuccessMSG_GenerateStruct", "Generate Struct Failed"));
-    }
+    StartJob(DataTableBatchJob::GenerateStruct(ExcelAry, CSVFolderPath, StructFolderPath, bHeaderPerSheet,
+        FOnBatchJobProgress::CreateSP(this, &SDataTableManager::OnJobProgress),
+        FOnBatchJobCompleted::CreateSP(this, &SDataTableManager::OnJobCompleted)));
 
     return FReply::Handled();
 }
@@ -295,29 +581,121 @@ FReply SDataTableManager::OnImportCSVClicked()
         return FReply::Handled();
     }
 
-    bool Result = false;
+    TArray<FDataTableImportItem> ImportItems;
 
     for (TSharedPtr<FSheetListRowData> Data : SheetListView->GetDataList())
     {
         if (Data.IsValid() && Data->IsChecked())
         {
-            Result = DataTableAssetGanerator::CreateDataTableFromCSV(Data->GetSheetName(), Data->GetCSVFullPath(), AssetFolderPath, Data->GetStructure());
-
-            if (Result == false)
-            {
-                break;
-            }
+            ImportItems.Add({ Data->GetSheetName(), Data->GetCSVFullPath(), Data->GetStructure(), bImportFromExcel ? Data->GetExcelFullPath() : FString() });
         }
     }
 
-    if (Result)
+    if (ImportItems.Num() == 0)
     {
-        FMessageDialog::Open(EAppMsgCategory::Success, EAppMsgType::Ok, LOCTEXT("SuccessMSG_CreateAsset", "Create Data Table Success"));
+        FMessageDialog::Open(EAppMsgCategory::Error, EAppMsgType::Ok, LOCTEXT("ErrorMSG_CreateAsset", "Create Data Table Failed"));
+        return FReply::Handled();
     }
-    else
+
+    StartJob(DataTableBatchJob::ImportDataTable(ImportItems, AssetFolderPath,
+        FOnBatchJobProgress::CreateSP(this, &SDataTableManager::OnJobProgress),
+        FOnBatchJobCompleted::CreateSP(this, &SDataTableManager::OnJobCompleted)));
+
+    return FReply::Handled();
+}
+
+FReply SDataTableManager::OnCancelJobClicked()
+{
+    if (RunningJob.IsValid())
     {
-        FMessageDialog::Open(EAppMsgCategory::Error, EAppMsgType::Ok, LOCTEXT("ErrorMSG_CreateAsset", "Create Data Table Failed"));
+        RunningJob->Cancel();
+        JobStatusText->SetText(LOCTEXT("JobStatus_Cancelling", "Cancelling..."));
     }
 
     return FReply::Handled();
 }
+
+bool SDataTableManager::IsIdle() const
+{
+    return RunningJob.IsValid() == false;
+}
+
+void SDataTableManager::StartJob(TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> InJob)
+{
+    RunningJob = InJob;
+    JobStatusText->SetText(LOCTEXT("JobStatus_Started", "Working..."));
+}
+
+void SDataTableManager::OnJobProgress(const FBatchJobProgress& InProgress)
+{
+    if (RunningJob.IsValid() == false || RunningJob->IsCancelled())
+    {
+        return;
+    }
+
+    const FString ItemName = InProgress.SheetName.IsEmpty() ? InProgress.ExcelName : InProgress.SheetName;
+    JobStatusText->SetText(FText::Format(LOCTEXT("JobStatus_Progress", "{0} / {1} : {2}"),
+        FText::AsNumber(InProgress.CompletedCount), FText::AsNumber(InProgress.TotalCount), FText::FromString(ItemName)));
+}
+
+void SDataTableManager::OnJobCompleted(const FBatchJobSummary& InSummary)
+{
+    RunningJob.Reset();
+    JobStatusText->SetText(FText::GetEmpty());
+
+    // Written CSVs reach the list through the CSV folder watcher, unless the job just created that folder
+    if (InSummary.Type == EBatchJobType::ConvertCSV && FolderWatches.Contains(EPathType::PATH_CSV) == false)
+    {
+        TryCacheCSVFiles();
+        SheetListView->RefreshCSVState(CSVFiles);
+    }
+
+    if (InSummary.bCancelled)
+    {
+        JobStatusText->SetText(FText::Format(LOCTEXT("JobStatus_Cancelled", "Cancelled ({0} done)"), FText::AsNumber(InSummary.SucceededCount)));
+        return;
+    }
+
+    const FText FailedList = FText::FromString(FString::Join(InSummary.Failures, TEXT("\n")));
+    const bool bFailed = InSummary.Failures.Num() > 0;
+
+    switch (InSummary.Type)
+    {
+    case EBatchJobType::ConvertCSV:
+        if (bFailed)
+        {
+            FMessageDialog::Open(EAppMsgCategory::Error, EAppMsgType::Ok, FText::Format(LOCTEXT("ErrorMSG_ConvertCSV", "Convert CSV Failed\n{0}"), FailedList));
+        }
+        else
+        {
+            FMessageDialog::Open(EAppMsgCategory::Success, EAppMsgType::Ok, FText::Format(LOCTEXT("SuccessMSG_ConvertCSV", "Convert CSV Success\n{0} converted, {1} already up to date"),
+                FText::AsNumber(InSummary.SucceededCount - InSummary.UpToDateCount), FText::AsNumber(InSummary.UpToDateCount)));
+        }
+        break;
+
+    case EBatchJobType::GenerateStruct:
+        if (bFailed)
+        {
+            FMessageDialog::Open(EAppMsgCategory::Error, EAppMsgType::Ok, FText::Format(LOCTEXT("ErrorMSG_GenerateStruct", "Generate Struct Failed\n{0}"), FailedList));
+        }
+        else
+        {
+            FMessageDialog::Open(EAppMsgCategory::Success, EAppMsgType::Ok, FText::Format(LOCTEXT("SuccessMSG_GenerateStruct", "Generate Struct Success\n{0} workbooks changed, {1} unchanged\nTo import csv with changed structs, please rebuild the project"),
+                FText::AsNumber(InSummary.SucceededCount - InSummary.UpToDateCount), FText::AsNumber(InSummary.UpToDateCount)));
+        }
+        break;
+
+    case EBatchJobType::ImportDataTable:
+        if (bFailed)
+        {
+            FMessageDialog::Open(EAppMsgCategory::Error, EAppMsgType::Ok, FText::Format(LOCTEXT("ErrorMSG_CreateAsset", "Create Data Table Failed\n{0}"), FailedList));
+        }
+        else
+        {
+            FMessageDialog::Open(EAppMsgCategory::Success, EAppMsgType::Ok, FText::Format(LOCTEXT("SuccessMSG_CreateAsset", "Create Data Table Success\n{0} tables ({1} unchanged) : {2} sec building, {3} sec saving\nRows : {4} added, {5} changed, {6} removed"),
+                FText::AsNumber(InSummary.SucceededCount), FText::AsNumber(InSummary.UpToDateCount), FText::AsNumber(InSummary.BuildSeconds), FText::AsNumber(InSummary.SaveSeconds),
+                FText::AsNumber(InSummary.RowStats.AddedRows), FText::AsNumber(InSummary.RowStats.ChangedRows), FText::AsNumber(InSummary.RowStats.RemovedRows)));
+        }
+        break;
+    }
+}
@@ -3,12 +3,23 @@
 #include "Widgets/Text/STextBlock.h"
 #include "Widgets/Input/SCheckBox.h"
 #include "Widgets/Views/SHeaderRow.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
 
 #include "XlsxManager.h"
+#include "RowStructIndex.h"
 #include "DataTableManager.h"
 
 #define LOCTEXT_NAMESPACE "DataTableManager"
 
+DECLARE_STATS_GROUP(TEXT("DataTableManager"), STATGROUP_DataTableManager, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Refresh Sheet State"), STAT_RefreshSheetState, STATGROUP_DataTableManager);
+DECLARE_CYCLE_STAT(TEXT("Add Listed Sheets"), STAT_AddListedSheets, STATGROUP_DataTableManager);
+DECLARE_CYCLE_STAT(TEXT("Refresh CSV State"), STAT_RefreshCSVState, STATGROUP_DataTableManager);
+DECLARE_CYCLE_STAT(TEXT("Index CSV Files"), STAT_IndexCSVFiles, STATGROUP_DataTableManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Listed Sheets"), STAT_ListedSheets, STATGROUP_DataTableManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Indexed CSV Files"), STAT_IndexedCSVFiles, STATGROUP_DataTableManager);
+
 static const FName ColumnID_SelectLabel("Select");
 static const FName ColumnID_SheetLabel("SheetName");
 static const FName ColumnID_ExcelLabel("ExcelName");
@@ -48,7 +59,7 @@ TSharedRef<SWidget> SSheetListRow::GetWidgetForColum(const FName& ColumnName)
     if (ColumnName == ColumnID_SelectLabel)
     {
         return SAssignNew(CheckBox, SCheckBox)
-            .IsChecked(ECheckBoxState::Unchecked)
+            .IsChecked(Item->IsChecked() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked)
             .OnCheckStateChanged(this, &SSheetListRow::OnCheckStateChanged);
     }
 
@@ -160,6 +171,11 @@ void SSheetListView::Construct(const FArguments& InArgs)
         ];
 }
 
+SSheetListView::~SSheetListView()
+{
+    CancelListing();
+}
+
 TSharedRef<ITableRow> SSheetListView::OnGenerateRowForList(TSharedPtr<FSheetListRowData> InItem, const TSharedRef<STableViewBase>& OwnerTable)
 {
     check(InItem.IsValid());
@@ -179,43 +195,241 @@ void SSheetListView::OnCheckStateChanged(ECheckBoxState NewState)
     }
 }
 
-void SSheetListView::RefreshSheetState(const TArray<FString>& ExcelFiles, const TArray<FString>& CSVFiles, TArray<TWeakObjectPtr<UScriptStruct>>& StructObjs)
+void SSheetListView::RefreshSheetState(const TArray<FString>& ExcelFiles, const TMap<FString, FString>& InCSVFiles)
 {
+    SCOPE_CYCLE_COUNTER(STAT_RefreshSheetState);
+
+    CancelListing();
+
     DataList.Empty();
+    CSVFiles = InCSVFiles;
     
     if (ControlCheckBox.IsValid())
     {
         ControlCheckBox->SetIsChecked(ECheckBoxState::Unchecked);
     }
 
+    SET_DWORD_STAT(STAT_ListedSheets, 0);
+    ListView->RequestListRefresh();
+
+    CurrentListing = MakeShared<FSheetListing, ESPMode::ThreadSafe>();
+    CurrentListing->StartTime = FPlatformTime::Seconds();
+
+    Workbooks.Reserve(ExcelFiles.Num());
     for (const FString& ExcelFile : ExcelFiles)
     {
-        TArray<FString> SheetsInExcel;
-        XlsxManager::FindAllSheetInExcelFile(SheetsInExcel, ExcelFile);
+        Workbooks.AddDefaulted_GetRef().ExcelFile = ExcelFile;
+    }
+    RemainingWorkbooks = Workbooks.Num();
+
+    for (int32 WorkbookIndex = 0; WorkbookIndex < Workbooks.Num(); WorkbookIndex++)
+    {
+        ListWorkbook(WorkbookIndex);
+    }
+}
+
+void SSheetListView::RefreshWorkbook(const FString& InExcelFile)
+{
+    if (CurrentListing.IsValid() == false)
+    {
+        return;
+    }
+
+    int32 WorkbookIndex = FindWorkbook(InExcelFile);
+    if (WorkbookIndex == INDEX_NONE)
+    {
+        // A new workbook goes after the listed ones, its rows are appended
+        WorkbookIndex = Workbooks.Num();
+        Workbooks.AddDefaulted_GetRef().ExcelFile = InExcelFile;
+    }
+
+    ListWorkbook(WorkbookIndex);
+}
+
+void SSheetListView::RemoveWorkbook(const FString& InExcelFile)
+{
+    const int32 WorkbookIndex = FindWorkbook(InExcelFile);
+    if (WorkbookIndex == INDEX_NONE)
+    {
+        return;
+    }
+
+    const FListedWorkbook& Workbook = Workbooks[WorkbookIndex];
+    if (Workbook.RowCount == INDEX_NONE)
+    {
+        RemainingWorkbooks = FMath::Max(RemainingWorkbooks - 1, 0);
+    }
+    else
+    {
+        DataList.RemoveAt(GetFirstRowIndex(WorkbookIndex), Workbook.RowCount);
+    }
+    Workbooks.RemoveAt(WorkbookIndex);
+
+    SET_DWORD_STAT(STAT_ListedSheets, DataList.Num());
+    ListView->RequestListRefresh();
+}
+
+void SSheetListView::SetCSVFile(const FString& InSheetName, const FString& InCSVFullPath)
+{
+    if (InCSVFullPath.IsEmpty())
+    {
+        CSVFiles.Remove(InSheetName);
+    }
+    else
+    {
+        CSVFiles.Add(InSheetName, InCSVFullPath);
+    }
+
+    // The same sheet name can come from several workbooks
+    for (const TSharedPtr<FSheetListRowData>& Data : DataList)
+    {
+        if (Data.IsValid() && Data->GetSheetName() == InSheetName)
+        {
+            Data->SetCSVFullPath(InCSVFullPath);
+        }
+    }
+}
+
+void SSheetListView::ListWorkbook(int32 InWorkbookIndex)
+{
+    FListedWorkbook& Workbook = Workbooks[InWorkbookIndex];
+    Workbook.RequestSerial = ++NextRequestSerial;
+
+    // Probing is file I/O only : every workbook is listed on its own task and reported back to the game thread
+    TWeakPtr<SSheetListView> WeakThis = StaticCastSharedRef<SSheetListView>(AsShared());
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, Listing = CurrentListing, ExcelFile = Workbook.ExcelFile, RequestSerial = Workbook.RequestSerial]()
+    {
+        if (Listing->bCancelled.load())
+        {
+            return;
+        }
 
-        for (const FString& SheetName : SheetsInExcel)
+        TArray<FString> SheetNames;
+        XlsxManager::FindAllSheetInExcelFile(SheetNames, ExcelFile);
+
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, Listing, ExcelFile, RequestSerial, SheetNames = MoveTemp(SheetNames)]()
         {
-            const FString* CSVFullPath = CSVFiles.FindByPredicate(FindBySheetName_Functer(SheetName));
-            const TWeakObjectPtr<UScriptStruct>* UStructObj = StructObjs.FindByPredicate(FindBySheetName_Functer(SheetName));
+            TSharedPtr<SSheetListView> SheetListView = WeakThis.Pin();
+            if (SheetListView.IsValid() && SheetListView->CurrentListing == Listing)
+            {
+                SheetListView->AddListedSheets(ExcelFile, RequestSerial, SheetNames);
+            }
+        });
+    });
+}
+
+void SSheetListView::AddListedSheets(const FString& InExcelFile, uint32 InRequestSerial, const TArray<FString>& InSheetNames)
+{
+    SCOPE_CYCLE_COUNTER(STAT_AddListedSheets);
 
-            DataList.Add(MakeShared<FSheetListRowData>(SheetName, ExcelFile, CSVFullPath == nullptr ? "" : *CSVFullPath, UStructObj == nullptr ? nullptr : (*UStructObj).Get(), false));
+    const int32 WorkbookIndex = FindWorkbook(InExcelFile);
+    if (WorkbookIndex == INDEX_NONE || Workbooks[WorkbookIndex].RequestSerial != InRequestSerial)
+    {
+        // Removed meanwhile, or listed again since this request was made
+        return;
+    }
+
+    FListedWorkbook& Workbook = Workbooks[WorkbookIndex];
+    const int32 FirstRowIndex = GetFirstRowIndex(WorkbookIndex);
+
+    // A workbook listed again keeps the selection of the sheets it still has
+    TSet<FString> CheckedSheets;
+    const bool bFirstListing = Workbook.RowCount == INDEX_NONE;
+    if (bFirstListing == false)
+    {
+        for (int32 RowIndex = FirstRowIndex; RowIndex < FirstRowIndex + Workbook.RowCount; RowIndex++)
+        {
+            if (DataList[RowIndex]->IsChecked())
+            {
+                CheckedSheets.Add(DataList[RowIndex]->GetSheetName());
+            }
         }
+        DataList.RemoveAt(FirstRowIndex, Workbook.RowCount);
     }
 
+    // Rows arriving after "select all" was checked join the selection
+    const bool bSelectAll = ControlCheckBox.IsValid() && ControlCheckBox->IsChecked();
+
+    TArray<TSharedPtr<FSheetListRowData>> Rows;
+    Rows.Reserve(InSheetNames.Num());
+    for (const FString& SheetName : InSheetNames)
+    {
+        const FString* CSVFullPath = CSVFiles.Find(SheetName);
+        UScriptStruct* UStructObj = RowStructIndex::Find(SheetName);
+
+        Rows.Add(MakeShared<FSheetListRowData>(SheetName, InExcelFile, CSVFullPath == nullptr ? "" : *CSVFullPath, UStructObj, bSelectAll || CheckedSheets.Contains(SheetName)));
+    }
+    DataList.Insert(MoveTemp(Rows), FirstRowIndex);
+    Workbook.RowCount = InSheetNames.Num();
+
+    SET_DWORD_STAT(STAT_ListedSheets, DataList.Num());
     ListView->RequestListRefresh();
+
+    if (bFirstListing && RemainingWorkbooks > 0 && --RemainingWorkbooks == 0)
+    {
+        UE_LOG(LogTemp, Log, TEXT("Listed %d sheets from %d workbooks in %.3f sec"), DataList.Num(), Workbooks.Num(), FPlatformTime::Seconds() - CurrentListing->StartTime);
+    }
 }
 
-void SSheetListView::RefreshCSVState(const TArray<FString>& CSVFiles)
+int32 SSheetListView::FindWorkbook(const FString& InExcelFile) const
 {
-    for (TSharedPtr<FSheetListRowData> Data : DataList)
+    return Workbooks.IndexOfByPredicate([&InExcelFile](const FListedWorkbook& Workbook) { return Workbook.ExcelFile == InExcelFile; });
+}
+
+int32 SSheetListView::GetFirstRowIndex(int32 InWorkbookIndex) const
+{
+    int32 RowIndex = 0;
+    for (int32 Index = 0; Index < InWorkbookIndex; Index++)
+    {
+        RowIndex += FMath::Max(Workbooks[Index].RowCount, 0);
+    }
+    return RowIndex;
+}
+
+void SSheetListView::CancelListing()
+{
+    if (CurrentListing.IsValid())
+    {
+        // Workbooks already being read finish, their rows are dropped on arrival
+        CurrentListing->bCancelled = true;
+        CurrentListing.Reset();
+    }
+    Workbooks.Empty();
+    RemainingWorkbooks = 0;
+}
+
+void SSheetListView::RefreshCSVState(const TMap<FString, FString>& InCSVFiles)
+{
+    SCOPE_CYCLE_COUNTER(STAT_RefreshCSVState);
+
+    CSVFiles = InCSVFiles;
+
+    for (const TSharedPtr<FSheetListRowData>& Data : DataList)
     {
         if (Data.IsValid())
         {
-            const FString* CSVFullPath = CSVFiles.FindByPredicate(FindBySheetName_Functer(Data->GetSheetName()));
-            if (CSVFullPath != nullptr)
-            {
-                Data->SetCSVFullPath(*CSVFullPath);
-            }
+            const FString* CSVFullPath = CSVFiles.Find(Data->GetSheetName());
+            Data->SetCSVFullPath(CSVFullPath == nullptr ? FString() : *CSVFullPath);
         }
     }
 }
+
+void SSheetListView::IndexCSVFiles(const TArray<FString>& InCSVFiles, TMap<FString, FString>& OutCSVFiles)
+{
+    SCOPE_CYCLE_COUNTER(STAT_IndexCSVFiles);
+
+    OutCSVFiles.Reset();
+    OutCSVFiles.Reserve(InCSVFiles.Num());
+
+    // FString keys hash and compare case-insensitively, the same match the file name comparison made
+    for (const FString& CSVFile : InCSVFiles)
+    {
+        const FString SheetName = FPaths::GetBaseFilename(CSVFile);
+        if (OutCSVFiles.Contains(SheetName) == false)
+        {
+            OutCSVFiles.Add(SheetName, CSVFile);
+        }
+    }
+
+    SET_DWORD_STAT(STAT_IndexedCSVFiles, OutCSVFiles.Num());
+}
@@ -3,9 +3,12 @@
 #include "CoreMinimal.h"
 #include "DataTableManagerConfig.h"
 #include "Widgets/SCompoundWidget.h"
+#include "DataTableBatchJob.h"
+#include "IDirectoryWatcher.h"
 
 class SFolderPathModifier;
 class SSheetListView;
+class STextBlock;
 
 class DATATABLEMODULE_API SDataTableManager : public SCompoundWidget
 {
@@ -15,6 +18,8 @@ public:
 
     void Construct(const FArguments& InArgs);
 
+    virtual ~SDataTableManager();
+
 private:
     void OnExcelFolderPathTextChanged(const FText& NewText);
     void OnCSVFolderPathTextChanged(const FText& NewText);
@@ -24,18 +29,55 @@ private:
     FReply OnCSVConverterClicked();
     FReply OnStructGeneratorClicked();
     FReply OnImportCSVClicked();
+    FReply OnCancelJobClicked();
+
+    // Background batch job
+    bool IsIdle() const;
+    void StartJob(TSharedRef<DataTableBatchJob, ESPMode::ThreadSafe> InJob);
+    void OnJobProgress(const FBatchJobProgress& InProgress);
+    void OnJobCompleted(const FBatchJobSummary& InSummary);
 
-    // Cached UStruct Based on FTableRowBase
-    void TryCacheUStructName();
     void TryCacheCSVFiles();
     void TryCacheExcelFiles();
 
+    // Folder watchers keep the cached files and the sheet list current without rescanning
+    void WatchFolder(EPathType InPathType, const FString& InFolderPath, IDirectoryWatcher::FDirectoryChanged InCallback);
+    void UnwatchFolder(EPathType InPathType);
+    void OnExcelFolderChanged(const TArray<FFileChangeData>& InChanges);
+    void OnCSVFolderChanged(const TArray<FFileChangeData>& InChanges);
+    void OnExcelFileChanged(const FString& InExcelFile);
+    void OnCSVFileChanged(const FString& InCSVFile);
+    // Re-picks the CSV of each sheet from the CSV folder, for names several subfolders may share
+    void ResolveCSVFiles(const TArray<FString>& InSheetNames);
+
 private:
     // Folder Path Modifier
     TMap<EPathType,TSharedPtr<SFolderPathModifier>> FolderPathModifiers;
     TSharedPtr<SSheetListView> SheetListView;
+    TSharedPtr<STextBlock> JobStatusText;
+
+    TSharedPtr<DataTableBatchJob, ESPMode::ThreadSafe> RunningJob;
+
+    // Convert sheets even when the CSV folder manifest shows them up to date
+    bool bForceRebuildCSV = false;
+
+    // Import reads the checked sheets from their workbooks, no CSV needed
+    bool bImportFromExcel = false;
+
+    // Conversion also writes each sheet's typed SheetCache, which import reads instead of the CSV
+    bool bWriteSheetCache = false;
+
+    // Struct generation writes <Sheet>.h per sheet instead of one header per workbook
+    bool bHeaderPerSheet = false;
+
+    struct FFolderWatch
+    {
+        FString FolderPath;
+        FDelegateHandle Handle;
+    };
+    TMap<EPathType, FFolderWatch> FolderWatches;
 
-    TArray<TWeakObjectPtr<UScriptStruct>> UStructObjs;
-    TArray<FString> CSVFiles;
+    // Sheet name -> CSV path
+    TMap<FString, FString> CSVFiles;
     TArray<FString> ExcelFiles;
 };
@@ -4,33 +4,13 @@
 #include "Widgets/SCompoundWidget.h"
 #include "Widgets/Views/SListView.h"
 
+#include <atomic>
+
 DECLARE_MULTICAST_DELEGATE(FDataChangedDelegate);
 
 class SFolderPathModifier;
 class SDataTableManager;
 
-struct FindBySheetName_Functer
-{
-public:
-    const FString& ExternalStr;
-
-    FindBySheetName_Functer(const FString& InExternalStr) : ExternalStr(InExternalStr) {}
-
-    bool operator()(const FString& Str) const
-    {
-        return FPaths::GetCleanFilename(Str) == (ExternalStr + ".csv");
-    }
-
-    bool operator()(const TWeakObjectPtr<UScriptStruct>& Obj) const
-    {
-        if (Obj.IsValid() == false)
-        {
-            return false;
-        }
-        return Obj->GetName() == ExternalStr;
-    }
-};
-
 struct FSheetListRowData
 {
 public:
@@ -183,20 +163,69 @@ public:
 
     void Construct(const FArguments& InArgs);
 
+    virtual ~SSheetListView();
+
 public:
     TSharedRef<ITableRow> OnGenerateRowForList(TSharedPtr<FSheetListRowData> InItem, const TSharedRef<STableViewBase>& OwnerTable);
 
     void OnCheckStateChanged(ECheckBoxState NewState);
 
-    void RefreshSheetState(const TArray<FString>& ExcelFiles, const TArray<FString>& CSVFiles, TArray<TWeakObjectPtr<UScriptStruct>>& StructObjs);
-    void RefreshCSVState(const TArray<FString>& CSVFiles);
+    // CSV files are keyed by sheet name, see IndexCSVFiles. Row structs are looked up by sheet name in RowStructIndex.
+    // Workbooks are listed on worker threads and their rows added as each one finishes, a listing still running is cancelled.
+    void RefreshSheetState(const TArray<FString>& ExcelFiles, const TMap<FString, FString>& InCSVFiles);
+    void RefreshCSVState(const TMap<FString, FString>& InCSVFiles);
+
+    // Deltas from the folder watchers : only rows of the given workbook or sheet are touched
+    void RefreshWorkbook(const FString& InExcelFile);
+    void RemoveWorkbook(const FString& InExcelFile);
+    // Empty InCSVFullPath when the sheet no longer has a CSV
+    void SetCSVFile(const FString& InSheetName, const FString& InCSVFullPath);
+
+    // True until every workbook of the last RefreshSheetState is listed
+    bool IsListingSheets() const { return RemainingWorkbooks > 0; }
+
+    // Sheet name -> CSV path, the first file found wins when subfolders hold the same name
+    static void IndexCSVFiles(const TArray<FString>& InCSVFiles, TMap<FString, FString>& OutCSVFiles);
 
     TArray<TSharedPtr<FSheetListRowData>>& GetDataList() { return DataList;  }
 
+private:
+    struct FSheetListing
+    {
+        std::atomic<bool> bCancelled{ false };
+        double StartTime = 0.0;
+    };
+
+    struct FListedWorkbook
+    {
+        FString ExcelFile;
+        // INDEX_NONE until the workbook is listed
+        int32 RowCount = INDEX_NONE;
+        // Latest listing request, results of older requests are dropped
+        uint32 RequestSerial = 0;
+    };
+
+    // Reads InWorkbookIndex's sheets on a worker thread
+    void ListWorkbook(int32 InWorkbookIndex);
+    // Game thread. Replaces a workbook's rows, placed after those of the workbooks before it.
+    void AddListedSheets(const FString& InExcelFile, uint32 InRequestSerial, const TArray<FString>& InSheetNames);
+    int32 FindWorkbook(const FString& InExcelFile) const;
+    int32 GetFirstRowIndex(int32 InWorkbookIndex) const;
+    void CancelListing();
+
 private:
     TSharedPtr<SListView<TSharedPtr<FSheetListRowData>>> ListView;
     TArray<TSharedPtr<FSheetListRowData>> DataList;
 
     TSharedPtr<SCheckBox> ControlCheckBox;
-};
 
+    // Latest CSV files, read when rows of a listed workbook are added
+    TMap<FString, FString> CSVFiles;
+
+    // Workbooks in list order, their rows are contiguous in DataList
+    TArray<FListedWorkbook> Workbooks;
+    TSharedPtr<FSheetListing, ESPMode::ThreadSafe> CurrentListing;
+    uint32 NextRequestSerial = 0;
+    // Workbooks of the last RefreshSheetState not listed yet
+    int32 RemainingWorkbooks = 0;
+};